@@ -1,7 +1,6 @@
 #include <memory>
 #include <stdio.h>
 #include <sys/socket.h>
-#include <sys/time.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <stdint.h>
@@ -9,304 +8,105 @@
 
 #include <Common/Util.h>
 #include <Common/MPU9250.h>
+#include <Navio+/Storage_Navio.h>
 #include <Navio2/LSM9DS1.h>
+#include <Navio2/Storage_Navio2.h>
 
 #include "./AHRS.hpp"
 
-#define G_SI 9.80665
-#define PI 3.14159
+// Parameter store record of the calibration, bump the version when CalibrationData changes
+static constexpr uint16_t kCalibrationKey = 1;
+static constexpr uint16_t kCalibrationVersion = 1;
 
-AHRS::AHRS(std::unique_ptr<InertialSensor> imu)
+AHRS::AHRS(std::unique_ptr<InertialSensor> imu) : filter(1, 0)
 {
   sensor = move(imu);
-  q0 = 1;
-  q1 = 0;
-  q2 = 0, q3 = 0;
-  twoKi = 0;
-  twoKp = 2;
+  sampleCursor = sensor->getSamples().getHead();
+  savedRevision = calibration.getRevision();
 }
-void AHRS::update(float dt)
-{
-  float recipNorm;
-  float q0q0, q0q1, q0q2, q0q3, q1q1, q1q2, q1q3, q2q2, q2q3, q3q3;
-  float hx, hy, bx, bz;
-  float halfvx, halfvy, halfvz, halfwx, halfwy, halfwz;
-  float halfex, halfey, halfez;
-  float qa, qb, qc;
-
-  float ax, ay, az;
-  float gx, gy, gz;
-  float mx, my, mz;
-
-  sensor->update();
-  sensor->readAccelerometer(&ax, &ay, &az);
-  sensor->readGyroscope(&gx, &gy, &gz);
-  sensor->readMagnetometer(&mx, &my, &mz);
-
-  // Use IMU algorithm if magnetometer measurement invalid (avoids NaN in magnetometer
-  // normalisation)
-  if ((mx == 0.0f) && (my == 0.0f) && (mz == 0.0f))
-  {
-    updateIMU(dt);
-    return;
-  }
-
-  // Compute feedback only if accelerometer measurement valid (avoids NaN in accelerometer
-  // normalisation)
-  if (!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f)))
-  {
-    // Normalise accelerometer measurement
-    recipNorm = invSqrt(ax * ax + ay * ay + az * az);
-    ax *= recipNorm;
-    ay *= recipNorm;
-    az *= recipNorm;
-
-    // Normalise magnetometer measurement
-    recipNorm = invSqrt(mx * mx + my * my + mz * mz);
-    mx *= recipNorm;
-    my *= recipNorm;
-    mz *= recipNorm;
-
-    // Auxiliary variables to avoid repeated arithmetic
-    q0q0 = q0 * q0;
-    q0q1 = q0 * q1;
-    q0q2 = q0 * q2;
-    q0q3 = q0 * q3;
-    q1q1 = q1 * q1;
-    q1q2 = q1 * q2;
-    q1q3 = q1 * q3;
-    q2q2 = q2 * q2;
-    q2q3 = q2 * q3;
-    q3q3 = q3 * q3;
-
-    // Reference direction of Earth's magnetic field
-    hx = 2.0f * (mx * (0.5f - q2q2 - q3q3) + my * (q1q2 - q0q3) + mz * (q1q3 + q0q2));
-    hy = 2.0f * (mx * (q1q2 + q0q3) + my * (0.5f - q1q1 - q3q3) + mz * (q2q3 - q0q1));
-    bx = sqrt(hx * hx + hy * hy);
-    bz = 2.0f * (mx * (q1q3 - q0q2) + my * (q2q3 + q0q1) + mz * (0.5f - q1q1 - q2q2));
-
-    // Estimated direction of gravity and magnetic field
-    halfvx = q1q3 - q0q2;
-    halfvy = q0q1 + q2q3;
-    halfvz = q0q0 - 0.5f + q3q3;
-    halfwx = bx * (0.5f - q2q2 - q3q3) + bz * (q1q3 - q0q2);
-    halfwy = bx * (q1q2 - q0q3) + bz * (q0q1 + q2q3);
-    halfwz = bx * (q0q2 + q1q3) + bz * (0.5f - q1q1 - q2q2);
-
-    // Error is sum of cross product between estimated direction and measured direction of field
-    // vectors
-    halfex = (ay * halfvz - az * halfvy) + (my * halfwz - mz * halfwy);
-    halfey = (az * halfvx - ax * halfvz) + (mz * halfwx - mx * halfwz);
-    halfez = (ax * halfvy - ay * halfvx) + (mx * halfwy - my * halfwx);
-
-    // Compute and apply integral feedback if enabled
-    if (twoKi > 0.0f)
-    {
-      integralFBx += twoKi * halfex * dt;  // integral error scaled by Ki
-      integralFBy += twoKi * halfey * dt;
-      integralFBz += twoKi * halfez * dt;
-      gx += integralFBx;  // apply integral feedback
-      gy += integralFBy;
-      gz += integralFBz;
-    }
-    else
-    {
-      integralFBx = 0.0f;  // prevent integral windup
-      integralFBy = 0.0f;
-      integralFBz = 0.0f;
-    }
-
-    // Apply proportional feedback
-    gx += twoKp * halfex;
-    gy += twoKp * halfey;
-    gz += twoKp * halfez;
-  }
 
-  // Integrate rate of change of quaternion
-  gx *= (0.5f * dt);  // pre-multiply common factors
-  gy *= (0.5f * dt);
-  gz *= (0.5f * dt);
-  qa = q0;
-  qb = q1;
-  qc = q2;
-  q0 += (-qb * gx - qc * gy - q3 * gz);
-  q1 += (qa * gx + qc * gz - q3 * gy);
-  q2 += (qa * gy - qb * gz + q3 * gx);
-  q3 += (qa * gz + qb * gy - qc * gx);
-
-  // Normalise quaternion
-  recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
-  q0 *= recipNorm;
-  q1 *= recipNorm;
-  q2 *= recipNorm;
-  q3 *= recipNorm;
+void AHRS::initialize()
+{
+  sensor->initialize();
+  filter.reset();
+  sampleCursor = sensor->getSamples().getHead();
 }
 
-void AHRS::updateIMU(float dt)
+void AHRS::updateIMU()
 {
-  float recipNorm;
-  float halfvx, halfvy, halfvz;
-  float halfex, halfey, halfez;
-  float qa, qb, qc;
-
-  float ax, ay, az;
-  float gx, gy, gz;
-
-  // Accel + gyro.
   sensor->update();
-  sensor->readAccelerometer(&ax, &ay, &az);
-  sensor->readGyroscope(&gx, &gy, &gz);
-
-  ax /= G_SI;
-  ay /= G_SI;
-  az /= G_SI;
-  gx *= (180 / PI) * 0.0175;
-  gy *= (180 / PI) * 0.0175;
-  gz *= (180 / PI) * 0.0175;
-
-  gx -= gyroOffset[0];
-  gy -= gyroOffset[1];
-  gz -= gyroOffset[2];
-
-  // Compute feedback only if accelerometer measurement valid (avoids NaN in accelerometer
-  // normalisation)
-  if (!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f)))
-  {
-    // Normalise accelerometer measurement
-    recipNorm = invSqrt(ax * ax + ay * ay + az * az);
-    ax *= recipNorm;
-    ay *= recipNorm;
-    az *= recipNorm;
-
-    // Estimated direction of gravity and vector perpendicular to magnetic flux
-    halfvx = q1 * q3 - q0 * q2;
-    halfvy = q0 * q1 + q2 * q3;
-    halfvz = q0 * q0 - 0.5f + q3 * q3;
-
-    // Error is sum of cross product between estimated and measured direction of gravity
-    halfex = (ay * halfvz - az * halfvy);
-    halfey = (az * halfvx - ax * halfvz);
-    halfez = (ax * halfvy - ay * halfvx);
-
-    // Compute and apply integral feedback if enabled
-    if (twoKi > 0.0f)
-    {
-      integralFBx += twoKi * halfex * dt;  // integral error scaled by Ki
-      integralFBy += twoKi * halfey * dt;
-      integralFBz += twoKi * halfez * dt;
-      gx += integralFBx;  // apply integral feedback
-      gy += integralFBy;
-      gz += integralFBz;
-    }
-    else
-    {
-      integralFBx = 0.0f;  // prevent integral windup
-      integralFBy = 0.0f;
-      integralFBz = 0.0f;
-    }
 
-    // Apply proportional feedback
-    gx += twoKp * halfex;
-    gy += twoKp * halfey;
-    gz += twoKp * halfez;
-  }
+  // Integrate every sample published since the previous call in one batch
+  ImuSample samples[InertialSensor::kSampleRingSize];
+  size_t count = 0;
+  while (count < InertialSensor::kSampleRingSize
+         && sensor->getSamples().next(sampleCursor, samples[count]))
+    ++count;
 
-  // Integrate rate of change of quaternion
-  gx *= (0.5f * dt);  // pre-multiply common factors
-  gy *= (0.5f * dt);
-  gz *= (0.5f * dt);
-  qa = q0;
-  qb = q1;
-  qc = q2;
-  q0 += (-qb * gx - qc * gy - q3 * gz);
-  q1 += (qa * gx + qc * gz - q3 * gy);
-  q2 += (qa * gy - qb * gz + q3 * gx);
-  q3 += (qa * gz + qb * gy - qc * gx);
-
-  // Normalise quaternion
-  recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
-  q0 *= recipNorm;
-  q1 *= recipNorm;
-  q2 *= recipNorm;
-  q3 *= recipNorm;
+  // The calibration learns from the raw samples, the filter gets corrected ones. The gyroscope
+  // bias is estimated whenever the sensor rests, so there is no calibration step at startup.
+  calibration.update({ samples, count });
+  for (size_t i = 0; i < count; ++i)
+    calibration.correct(samples[i]);
+  filter.update({ samples, count });
+
+  float mx, my, mz;
+  sensor->readMagnetometer(&mx, &my, &mz);
+  calibration.updateMagnetometer({ mx, my, mz });
 }
 
-void AHRS::setGyroOffset()
+void AHRS::loadCalibration(ParameterStore& store)
 {
-  //---------------------- Calculate the offset -----------------------------
-
-  float offset[3] = { 0, 0, 0 };
-  float gx, gy, gz;
-
-  //----------------------- MPU initialization ------------------------------
-
-  sensor->initialize();
-
-  //-------------------------------------------------------------------------
-
-  printf("Beginning Gyro calibration...\n");
-  for (int i = 0; i < 100; ++i)
+  CalibrationData data;
+  if (store.load(kCalibrationKey, kCalibrationVersion, data))
   {
-    sensor->update();
-    sensor->readGyroscope(&gx, &gy, &gz);
-
-    gx *= 180 / PI;
-    gy *= 180 / PI;
-    gz *= 180 / PI;
-
-    offset[0] += gx * 0.0175;
-    offset[1] += gy * 0.0175;
-    offset[2] += gz * 0.0175;
-
-    usleep(10000);
+    calibration.setCalibration(data);
+    printf("Loaded calibration\n");
   }
-  offset[0] /= 100.0;
-  offset[1] /= 100.0;
-  offset[2] /= 100.0;
-
-  printf("Offsets are: %f %f %f\n", offset[0], offset[1], offset[2]);
-
-  gyroOffset[0] = offset[0];
-  gyroOffset[1] = offset[1];
-  gyroOffset[2] = offset[2];
+  savedRevision = calibration.getRevision();
 }
 
-void AHRS::getEuler(float* roll, float* pitch, float* yaw)
+void AHRS::saveCalibration(ParameterStore& store)
 {
-  *roll = atan2(2 * (q0 * q1 + q2 * q3), 1 - 2 * (q1 * q1 + q2 * q2)) * 180.0 / M_PI;
-  *pitch = asin(2 * (q0 * q2 - q3 * q1)) * 180.0 / M_PI;
-  *yaw = atan2(2 * (q0 * q3 + q1 * q2), 1 - 2 * (q2 * q2 + q3 * q3)) * 180.0 / M_PI;
+  if (calibration.getRevision() != savedRevision
+      && store.save(kCalibrationKey, kCalibrationVersion, calibration.getCalibration()))
+    savedRevision = calibration.getRevision();
 }
 
-float AHRS::invSqrt(float x)
+void AHRS::getEuler(float* roll, float* pitch, float* yaw)
 {
-  float halfx = 0.5f * x;
-  float y = x;
-  long i = *(long*)&y;
-  i = 0x5f3759df - (i >> 1);
-  y = *(float*)&i;
-  y = y * (1.5f - (halfx * y * y));
-  return y;
+  filter.getEuler(roll, pitch, yaw);
+  *roll *= 180.0 / M_PI;
+  *pitch *= 180.0 / M_PI;
+  *yaw *= 180.0 / M_PI;
 }
 
 float AHRS::getW()
 {
-  return q0;
+  float w, x, y, z;
+  filter.getQuaternion(&w, &x, &y, &z);
+  return w;
 }
 
 float AHRS::getX()
 {
-  return q1;
+  float w, x, y, z;
+  filter.getQuaternion(&w, &x, &y, &z);
+  return x;
 }
 
 float AHRS::getY()
 {
-  return q2;
+  float w, x, y, z;
+  filter.getQuaternion(&w, &x, &y, &z);
+  return y;
 }
 
 float AHRS::getZ()
 {
-  return q3;
+  float w, x, y, z;
+  filter.getQuaternion(&w, &x, &y, &z);
+  return z;
 }
 
 class Socket
@@ -411,37 +211,35 @@ std::string get_sensor_name(int argc, char* argv[])
 
 //============================== Main loop ====================================
 
-void imuLoop(AHRS* ahrs, Socket sock)
+void imuLoop(AHRS* ahrs, Socket sock, ParameterStore* store)
 {
   // Orientation data
 
   float roll, pitch, yaw;
 
-  struct timeval tv;
   float dt;
   // Timing data
 
   static float maxdt;
   static float mindt = 0.01;
   static float dtsumm = 0;
+  static float savesumm = 0;
   static int isFirst = 1;
   static uint64_t previoustime, currenttime;
 
   //----------------------- Calculate delta time ----------------------------
 
-  gettimeofday(&tv, nullptr);
   previoustime = currenttime;
-  currenttime = 1000000 * tv.tv_sec + tv.tv_usec;
-  dt = (currenttime - previoustime) / 1000000.0;
+  currenttime = get_time_ns();
+  dt = (currenttime - previoustime) / 1e9;
   if (dt < 1 / 1300.0)
     usleep((1 / 1300.0 - dt) * 1000000);
-  gettimeofday(&tv, nullptr);
-  currenttime = 1000000 * tv.tv_sec + tv.tv_usec;
-  dt = (currenttime - previoustime) / 1000000.0;
+  currenttime = get_time_ns();
+  dt = (currenttime - previoustime) / 1e9;
 
   //-------- Read raw measurements from the MPU and update AHRS --------------
 
-  ahrs->updateIMU(dt);
+  ahrs->updateIMU();
 
   //------------------------ Read Euler angles ------------------------------
 
@@ -473,6 +271,16 @@ void imuLoop(AHRS* ahrs, Socket sock)
 
     dtsumm = 0;
   }
+
+  //------------------ Keep the learned calibration across runs -------------
+
+  savesumm += dt;
+  if (savesumm > 10)
+  {
+    if (store)
+      ahrs->saveCalibration(*store);
+    savesumm = 0;
+  }
 }
 
 //=============================================================================
@@ -516,9 +324,42 @@ int main(int argc, char* argv[])
 
   auto ahrs = std::unique_ptr<AHRS>{ new AHRS(move(imu)) };
 
-  //-------------------- Setup gyroscope offset -----------------------------
+  //-------------------- Sensor and calibration setup ----------------------
+
+  ahrs->initialize();
+
+  // FRAM on Navio+, a file on Navio2
+  std::unique_ptr<Storage> storage;
+  if (get_navio_version() == NAVIO2)
+    storage = std::unique_ptr<Storage>{ new Storage_Navio2() };
+  else
+    storage = std::unique_ptr<Storage>{ new Storage_Navio() };
+
+  std::unique_ptr<ParameterStore> store;
+  if (storage->initialize())
+  {
+    store = std::unique_ptr<ParameterStore>{ new ParameterStore(*storage) };
+    if (store->open())
+    {
+      ahrs->loadCalibration(*store);
+    }
+    else if (get_navio_version() == NAVIO2)
+    {
+      // The file is ours alone, an unrecognised one is new or corrupt
+      printf("Creating a parameter store\n");
+      if (!store->format())
+        store.reset();
+    }
+    else
+    {
+      // The FRAM may hold someone else's data, never format it behind their back
+      printf("The FRAM holds no parameter store\n");
+      store.reset();
+    }
+  }
+  if (!store)
+    printf("Calibration will not be saved\n");
 
-  ahrs->setGyroOffset();
   while (1)
-    imuLoop(ahrs.get(), sock);
+    imuLoop(ahrs.get(), sock, store.get());
 }
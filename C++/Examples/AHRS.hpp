@@ -4,27 +4,36 @@
 #include <memory>
 #include <stdio.h>
 
+#include <Common/Calibration.h>
 #include <Common/InertialSensor.h>
+#include <Common/MahonyFilter.h>
+#include <Common/ParameterStore.h>
 
 class AHRS
 {
 private:
-  float q0, q1, q2, q3;
-  float gyroOffset[3];
-  float twoKi;
-  float twoKp;
-  float integralFBx, integralFBy, integralFBz;
   std::unique_ptr<InertialSensor> sensor;
+  MahonyFilter filter;
+  OnlineCalibration calibration;
+  uint64_t sampleCursor;
+  uint32_t savedRevision;
 
 public:
   AHRS(std::unique_ptr<InertialSensor> imu);
 
-  void update(float dt);
-  void updateIMU(float dt);
-  void setGyroOffset();
+  void initialize();
+  void updateIMU();
+
+  /** Start from a calibration saved by saveCalibration(), if the store holds one.
+   */
+  void loadCalibration(ParameterStore& store);
+
+  /** Save the calibration if it changed since it was loaded or last saved.
+   */
+  void saveCalibration(ParameterStore& store);
+
   void getEuler(float* roll, float* pitch, float* yaw);
 
-  float invSqrt(float x);
   float getW();
   float getX();
   float getY();
@@ -4,6 +4,9 @@
 #include <Common/MS5611.h>
 #include <Common/Util.h>
 
+#define LOOP_PERIOD 1000  // [us]
+#define PRINT_EVERY 100   // [samples]
+
 int main()
 {
   MS5611 barometer;
@@ -15,23 +18,22 @@ int main()
 
   barometer.initialize();
 
-  while (true)
-  {
-    barometer.refreshPressure();
-    usleep(10000);  // Waiting for pressure data ready
-    barometer.readPressure();
-
-    barometer.refreshTemperature();
-    usleep(10000);  // Waiting for temperature data ready
-    barometer.readTemperature();
+  // One temperature conversion for every 4 pressure conversions
+  barometer.configure(MS5611_OSR_4096, 4);
 
-    barometer.calculatePressureAndTemperature();
+  uint32_t samples = 0;
 
-    printf(
-      "Temperature(C): %f Pressure(millibar): %f\n", barometer.getTemperature(),
-      barometer.getPressure());
-
-    sleep(1);
+  while (true)
+  {
+    // tick() never blocks, other periodic work can share this loop
+    if (barometer.tick() && ++samples % PRINT_EVERY == 0)
+    {
+      printf(
+        "Temperature(C): %f Pressure(millibar): %f\n", barometer.getTemperature(),
+        barometer.getPressure());
+    }
+
+    usleep(LOOP_PERIOD);
   }
 
   return 0;
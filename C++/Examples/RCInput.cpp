@@ -7,7 +7,7 @@
 #include <Navio+/RCInput_Navio.h>
 #include <Navio2/RCInput_Navio2.h>
 
-#define READ_FAILED -1
+#define POLL_INTERVAL 10000  // [us]
 
 using namespace std;
 
@@ -36,17 +36,20 @@ int main()
 
   rcin->initialize();
 
+  RCFrame frame;
   while (true)
   {
-    for (int ch = 0; ch < 14; ++ch)
+    if (rcin->readFrame(frame))
     {
-      int period = rcin->read(ch);
-      if (period == READ_FAILED)
-        return EXIT_FAILURE;
-      cout << "Channel: " << ch << ", Period: " << period << endl;
+      cout << "Frame " << frame.sequence << " at " << frame.timestamp / 1000000 << " ms";
+      if (frame.failsafe)
+        cout << " (failsafe)";
+      cout << ":";
+      for (int ch = 0; ch < frame.channel_count; ++ch)
+        cout << " " << frame.channels[ch];
+      cout << endl;
     }
-    cout << endl;
-    sleep(1);
+    usleep(POLL_INTERVAL);
   }
 
   return 0;
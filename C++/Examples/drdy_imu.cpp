@@ -0,0 +1,55 @@
+#include <atomic>
+#include <cstdio>
+#include <unistd.h>
+
+#include <Common/gpio.h>
+#include <Common/ImuAcquisition.h>
+#include <Common/MPU9250.h>
+#include <Common/Util.h>
+
+#define ACQUISITION_PRIORITY 50  // SCHED_FIFO, requires root
+
+int main()
+{
+  if (check_apm())
+  {
+    return 1;
+  }
+
+  MPU9250 imu;
+
+  if (!imu.probe())
+  {
+    printf("Sensor not enabled\n");
+    return EXIT_FAILURE;
+  }
+  imu.initialize();
+  imu.enableDataReadyInterrupt();
+
+  GpioEdgeSource drdy(RPI_GPIO_23);
+  std::atomic<uint32_t> samples(0);
+
+  ImuAcquisition acquisition(imu, drdy, [&samples](InertialSensor&) { ++samples; });
+
+  if (!acquisition.start(ACQUISITION_PRIORITY))
+  {
+    printf("Error: Failed to start acquisition thread\n");
+    return EXIT_FAILURE;
+  }
+
+  while (true)
+  {
+    sleep(1);
+
+    ImuSample sample;
+    if (!imu.readSample(sample))
+      continue;
+
+    printf(
+      "Rate: %uHz Timeouts: %u Acc: %+7.3f %+7.3f %+7.3f Gyr: %+8.3f %+8.3f %+8.3f\n",
+      samples.exchange(0), acquisition.getTimeouts(), sample.ax, sample.ay, sample.az,
+      sample.gx, sample.gy, sample.gz);
+  }
+
+  return 0;
+}
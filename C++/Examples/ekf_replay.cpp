@@ -0,0 +1,107 @@
+/*
+Replay a recorded sensor log through ErrorStateEKF and print the estimate at every GPS fix.
+
+The log is text, one record per line, timestamps in CLOCK_MONOTONIC_RAW nanoseconds:
+  I <timestamp> <ax> <ay> <az> <gx> <gy> <gz>         IMU sample [m/s^2, rad/s], FRD body frame
+  P <timestamp> <lat> <lon> <hMSL> <velN> <velE> <velD> <fixType> <gnssFixOk>   UBX-NAV-PVT
+  C <timestamp> <posNN> <posNE> <posND> <posEE> <posED> <posDD>
+                <velNN> <velNE> <velND> <velEE> <velED> <velDD>                    UBX-NAV-COV
+  B <timestamp> <pressure>                            MS5611 pressure [mbar]
+
+Usage: ./ekf_replay log.txt
+*/
+
+#include <cstdio>
+#include <cinttypes>
+
+#include <Common/ErrorStateEKF.h>
+
+/* Drop the rest of the current line, e.g. after a short or unknown record */
+static void skipLine(FILE* file)
+{
+  int c;
+  do
+    c = getc(file);
+  while (c != '\n' && c != EOF);
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 2)
+  {
+    fprintf(stderr, "Usage: %s log.txt\n", argv[0]);
+    return 1;
+  }
+
+  FILE* log = fopen(argv[1], "r");
+  if (!log)
+  {
+    perror("fopen");
+    return 1;
+  }
+
+  ErrorStateEKF ekf;
+  char type;
+  uint64_t timestamp;
+
+  printf("timestamp,north,east,down,vel_north,vel_east,vel_down,qw,qx,qy,qz\n");
+  while (fscanf(log, " %c", &type) == 1)
+  {
+    if (fscanf(log, "%" SCNu64, &timestamp) != 1)
+    {
+      skipLine(log);  // Not a record
+      continue;
+    }
+
+    if (type == 'I')
+    {
+      ImuSample sample;
+      sample.timestamp = timestamp;
+      if (fscanf(log, "%f %f %f %f %f %f", &sample.ax, &sample.ay, &sample.az, &sample.gx,
+                 &sample.gy, &sample.gz) == 6)
+        ekf.predict(sample);
+    }
+    else if (type == 'P')
+    {
+      NavPvtPayload pvt = {};
+      int fix_type, fix_ok;
+      pvt.timestamp = timestamp;
+      if (fscanf(log, "%lf %lf %lf %lf %lf %lf %d %d", &pvt.lat, &pvt.lon, &pvt.hMSL, &pvt.velN,
+                 &pvt.velE, &pvt.velD, &fix_type, &fix_ok) == 8)
+      {
+        pvt.fixType = fix_type;
+        pvt.gnssFixOk = fix_ok;
+        ekf.updateGps(pvt);
+
+        const auto& state = ekf.getState();
+        printf(
+          "%" PRIu64 ",%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.5f,%.5f,%.5f,%.5f\n", state.timestamp,
+          state.position.x, state.position.y, state.position.z, state.velocity.x, state.velocity.y,
+          state.velocity.z, state.attitude.w, state.attitude.x, state.attitude.y, state.attitude.z);
+      }
+    }
+    else if (type == 'C')
+    {
+      NavCovPayload cov;
+      cov.timestamp = timestamp;
+      if (fscanf(log, "%lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf", &cov.posCovNN,
+                 &cov.posCovNE, &cov.posCovND, &cov.posCovEE, &cov.posCovED, &cov.posCovDD,
+                 &cov.velCovNN, &cov.velCovNE, &cov.velCovND, &cov.velCovEE, &cov.velCovED,
+                 &cov.velCovDD) == 12)
+        ekf.updateGpsCovariance(cov);
+    }
+    else if (type == 'B')
+    {
+      float pressure;
+      if (fscanf(log, "%f", &pressure) == 1)
+        ekf.updateBaro(timestamp, pressure);
+    }
+
+    // Whatever is left of the record: nothing when it was complete, the rest of a short or
+    // unknown one
+    skipLine(log);
+  }
+
+  fclose(log);
+  return 0;
+}
@@ -5,7 +5,7 @@
 #include <Common/Util.h>
 
 #define MEASUREMENT_RATE 100  // [ms]
-#define SLEEP_TIME 200        // [us]
+#define POLL_INTERVAL 10000   // [us]
 
 using namespace std;
 
@@ -19,13 +19,6 @@ int main()
   // Ublox class instance
   Ublox gps;
 
-  // Payloads
-  NavPosllhPayload posllh;
-  NavStatusPayload status;
-  NavPvtPayload pvt;
-  NavVelnedPayload velned;
-  NavCovPayload cov;
-
   // Set message rate
   gps.enableMsg(Ublox::NAV_POSLLH, false);
   gps.enableMsg(Ublox::NAV_STATUS, true);
@@ -46,37 +39,29 @@ int main()
   uint32_t cnt_velned = 0;
   uint32_t cnt_cov = 0;
 
+  // Callbacks are called from poll() with the decoded payloads
+  gps.subscribe([&](const NavPosllhPayload& posllh) {
+    cout << "NAV_POSLLH(" << ++cnt_posllh << "):" << endl << posllh << endl;
+  });
+  gps.subscribe([&](const NavStatusPayload& status) {
+    cout << "NAV_STATUS(" << ++cnt_status << "):" << endl << status << endl;
+  });
+  gps.subscribe([&](const NavPvtPayload& pvt) {
+    cout << "NAV_PVT(" << ++cnt_pvt << "):" << endl << pvt << endl;
+  });
+  gps.subscribe([&](const NavVelnedPayload& velned) {
+    cout << "NAV_VELNED(" << ++cnt_velned << "):" << endl << velned << endl;
+  });
+  gps.subscribe([&](const NavCovPayload& cov) {
+    cout << "NAV_COV(" << ++cnt_cov << "):" << endl << cov << endl;
+  });
+
   while (true)
   {
-    const auto msg_id = gps.update();
-
-    switch (msg_id)
-    {
-      case Ublox::NAV_POSLLH:
-        gps.decode(posllh);
-        cout << "NAV_POSLLH(" << ++cnt_posllh << "):" << endl << posllh << endl;
-        break;
-      case Ublox::NAV_STATUS:
-        gps.decode(status);
-        cout << "NAV_STATUS(" << ++cnt_status << "):" << endl << status << endl;
-        break;
-      case Ublox::NAV_PVT:
-        gps.decode(pvt);
-        cout << "NAV_PVT(" << ++cnt_pvt << "):" << endl << pvt << endl;
-        break;
-      case Ublox::NAV_VELNED:
-        gps.decode(velned);
-        cout << "NAV_VELNED(" << ++cnt_velned << "):" << endl << velned << endl;
-        break;
-      case Ublox::NAV_COV:
-        gps.decode(cov);
-        cout << "NAV_COV(" << ++cnt_cov << "):" << endl << cov << endl;
-        break;
-      default:
-        break;
-    }
+    // Returns as soon as the receiver has nothing more to send, other work can share this loop
+    gps.poll();
 
-    usleep(SLEEP_TIME);
+    usleep(POLL_INTERVAL);
   }
 
   return 0;
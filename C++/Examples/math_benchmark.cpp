@@ -0,0 +1,162 @@
+/*
+Time the linalg kernels used by the estimators against the hand-expanded float array code they
+replaced: one Mahony filter step and the 15x15 covariance propagation F * P * F^T of the EKF.
+
+Usage: ./math_benchmark [iterations]
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <Common/Util.h>
+#include <Common/linalg.hpp>
+
+using linalg::Mat;
+using linalg::Quat;
+using linalg::Vec3;
+
+namespace
+{
+constexpr size_t kN = 15;
+constexpr float kDt = 0.001f;
+
+volatile float sink;  // Keeps results alive under optimization
+
+/* Mahony step as written out on float arrays */
+void mahonyArrays(float (&q)[4], const float (&a)[3], const float (&g)[3])
+{
+  float ax = a[0], ay = a[1], az = a[2];
+  float recip_norm = 1.f / std::sqrt(ax * ax + ay * ay + az * az);
+  ax *= recip_norm;
+  ay *= recip_norm;
+  az *= recip_norm;
+
+  const float half_vx = q[1] * q[3] - q[0] * q[2];
+  const float half_vy = q[0] * q[1] + q[2] * q[3];
+  const float half_vz = q[0] * q[0] - 0.5f + q[3] * q[3];
+  const float ex = ay * half_vz - az * half_vy;
+  const float ey = az * half_vx - ax * half_vz;
+  const float ez = ax * half_vy - ay * half_vx;
+
+  const float gx = (g[0] + 2 * ex) * 0.5f * kDt;
+  const float gy = (g[1] + 2 * ey) * 0.5f * kDt;
+  const float gz = (g[2] + 2 * ez) * 0.5f * kDt;
+  const float w = q[0], x = q[1], y = q[2], z = q[3];
+  q[0] = w - x * gx - y * gy - z * gz;
+  q[1] = x + w * gx + y * gz - z * gy;
+  q[2] = y + w * gy - x * gz + z * gx;
+  q[3] = z + w * gz + x * gy - y * gx;
+
+  recip_norm = 1.f / std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+  for (auto& value : q)
+    value *= recip_norm;
+}
+
+Quat mahonyLinalg(const Quat& q, const Vec3& a, const Vec3& g)
+{
+  const Vec3 half_gravity = q.toRotation().row(2) * 0.5f;
+  const Vec3 error = a.normalized().cross(half_gravity);
+  return q.integrated((g + error * 2.f) * kDt);
+}
+
+/* F * P * F^T as written out on float arrays, full product twice */
+void propagateArrays(const float (&f)[kN][kN], float (&p)[kN][kN])
+{
+  float fp[kN][kN];
+  for (size_t i = 0; i < kN; ++i)
+  {
+    for (size_t j = 0; j < kN; ++j)
+    {
+      float sum = 0;
+      for (size_t k = 0; k < kN; ++k)
+        sum += f[i][k] * p[k][j];
+      fp[i][j] = sum;
+    }
+  }
+  for (size_t i = 0; i < kN; ++i)
+  {
+    for (size_t j = 0; j < kN; ++j)
+    {
+      float sum = 0;
+      for (size_t k = 0; k < kN; ++k)
+        sum += fp[i][k] * f[j][k];
+      p[i][j] = sum;
+    }
+  }
+}
+
+Mat<kN, kN> makeJacobian()
+{
+  Mat<kN, kN> f = Mat<kN, kN>::identity();
+  for (size_t i = 0; i < kN; ++i)
+  {
+    for (size_t j = 0; j < kN; ++j)
+      f[i][j] += 1e-3f * std::sin(float(i * kN + j));
+  }
+  return f;
+}
+
+void report(const char* name, uint64_t start, uint64_t end, size_t iterations)
+{
+  printf("%-28s %8.1f ns\n", name, double(end - start) / iterations);
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  const size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+  const Vec3 accel = { 0.3f, -0.2f, -9.7f };
+  const Vec3 gyro = { 0.01f, -0.02f, 0.005f };
+
+  float q_arrays[4] = { 1, 0, 0, 0 };
+  const float a_arrays[3] = { accel.x, accel.y, accel.z };
+  const float g_arrays[3] = { gyro.x, gyro.y, gyro.z };
+  uint64_t start = get_time_ns();
+  for (size_t i = 0; i < iterations; ++i)
+    mahonyArrays(q_arrays, a_arrays, g_arrays);
+  report("Mahony step, arrays", start, get_time_ns(), iterations);
+  sink = q_arrays[0];
+
+  Quat q = Quat::identity();
+  start = get_time_ns();
+  for (size_t i = 0; i < iterations; ++i)
+    q = mahonyLinalg(q, accel, gyro);
+  report("Mahony step, linalg", start, get_time_ns(), iterations);
+  sink = q.w;
+
+  const float difference = std::fabs(q.w - q_arrays[0]) + std::fabs(q.x - q_arrays[1])
+                           + std::fabs(q.y - q_arrays[2]) + std::fabs(q.z - q_arrays[3]);
+  printf("Quaternion difference: %g\n", difference);
+
+  // Each round feeds the next, as in the filter, so the work cannot be hoisted out of the loop
+  const size_t rounds = iterations / 100 + 1;
+  const Mat<kN, kN> f = makeJacobian();
+  Mat<kN, kN> p = Mat<kN, kN>::identity();
+  float p_arrays[kN][kN];
+  for (size_t i = 0; i < kN; ++i)
+  {
+    for (size_t j = 0; j < kN; ++j)
+      p_arrays[i][j] = p[i][j];
+  }
+
+  start = get_time_ns();
+  for (size_t i = 0; i < rounds; ++i)
+  {
+    propagateArrays(f.m, p_arrays);
+    p_arrays[0][0] = 1;
+  }
+  report("F * P * F^T, arrays", start, get_time_ns(), rounds);
+  sink = p_arrays[kN - 1][kN - 1];
+
+  start = get_time_ns();
+  for (size_t i = 0; i < rounds; ++i)
+  {
+    p = sandwich(f, p);
+    p[0][0] = 1;
+  }
+  report("F * P * F^T, linalg", start, get_time_ns(), rounds);
+  sink = p[kN - 1][kN - 1];
+
+  return 0;
+}
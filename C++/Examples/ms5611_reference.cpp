@@ -0,0 +1,29 @@
+/*
+Check the MS5611 integer compensation against the worked example of the datasheet
+(MS5611-01BA03, "Pressure and temperature calculation"). Needs no hardware.
+
+Usage: ./ms5611_reference
+*/
+
+#include <cstdio>
+
+#include <Common/MS5611.h>
+
+int main()
+{
+  const uint16_t C[6] = { 40127, 36924, 23317, 23282, 33464, 28312 };
+  const uint32_t D1 = 9085466;
+  const uint32_t D2 = 8569150;
+
+  int32_t temperature, pressure;
+  MS5611::compensate(C, D1, D2, temperature, pressure);
+
+  printf("TEMP = %d (expected 2007), P = %d (expected 100009)\n", temperature, pressure);
+  if (temperature != 2007 || pressure != 100009)
+  {
+    fprintf(stderr, "MS5611 compensation does not match the datasheet\n");
+    return 1;
+  }
+
+  return 0;
+}
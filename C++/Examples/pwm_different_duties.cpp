@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <memory>
 #include <iostream>
 #include <unistd.h>
@@ -52,15 +53,15 @@ int main(int, char** argv)
 
   // Send disarm command
   cout << "Send disarm command for " << DISARM_DURATION << " seconds." << endl;
+  double frame[SERVO_RAIL_SIZE];
+  fill(begin(frame), end(frame), PWM_DISARM);
+  pwm.writeFrame(frame);
   for (int _ = 0; _ < DISARM_DURATION / INTERVAL; ++_)
   {
-    for (uint32_t channel = 0; channel < SERVO_RAIL_SIZE; ++channel)
+    if (!pwm.commit())
     {
-      if (!pwm.setDutyCycle(channel, PWM_DISARM))
-      {
-        cerr << "Failed to set disarm duty cycle on channel " << channel << endl;
-        return 1;
-      }
+      cerr << "Failed to set disarm duty cycles" << endl;
+      return 1;
     }
     usleep(INTERVAL * 1e+6);
   }
@@ -68,18 +69,18 @@ int main(int, char** argv)
   // If commands are sent immediately after disarming, the motors will rotate.
   cout << "Start to send PWM commands." << endl;
 
-  // Servo control loop
+  // Servo control loop, every channel is updated together once per tick
   while (true)
   {
     for (uint32_t channel = 0; channel < SERVO_RAIL_SIZE; ++channel)
     {
       const double rate = static_cast<double>(channel) / static_cast<double>(SERVO_RAIL_SIZE);
-      const double period = PWM_MIN + (PWM_MAX - PWM_MIN) * rate;
-      if (!pwm.setDutyCycle(channel, period))
-      {
-        cerr << "Failed to set PWM duty cycle on channel " << channel << endl;
-        return 1;
-      }
+      frame[channel] = PWM_MIN + (PWM_MAX - PWM_MIN) * rate;
+    }
+    if (!pwm.writeFrame(frame) || !pwm.commit())
+    {
+      cerr << "Failed to set PWM duty cycles" << endl;
+      return 1;
     }
     usleep(INTERVAL * 1e+6);
   }
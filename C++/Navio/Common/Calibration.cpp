@@ -0,0 +1,296 @@
+#include <cmath>
+
+#include "./Calibration.h"
+
+using linalg::Mat;
+using linalg::Vec3;
+
+namespace
+{
+constexpr float kGravity = 9.80665f;   // [m/s^2]
+constexpr float kPriorVariance = 1.f;  // Of the normalized ellipsoid parameters
+constexpr float kCoverage = 1.f;       // Extent of the points on every axis, relative
+constexpr size_t kMinWindowSamples = 10;
+}  // namespace
+
+void OnlineCalibration::Coverage::reset()
+{
+  min = { INFINITY, INFINITY, INFINITY };
+  max = { -INFINITY, -INFINITY, -INFINITY };
+}
+
+void OnlineCalibration::Coverage::add(const Vec3& point)
+{
+  for (size_t i = 0; i < 3; ++i)
+  {
+    min[i] = std::fmin(min[i], point[i]);
+    max[i] = std::fmax(max[i], point[i]);
+  }
+}
+
+bool OnlineCalibration::Coverage::spans(float extent) const
+{
+  return max.x - min.x > extent && max.y - min.y > extent && max.z - min.z > extent;
+}
+
+OnlineCalibration::OnlineCalibration() : OnlineCalibration(Params())
+{
+}
+
+OnlineCalibration::OnlineCalibration(const Params& params) : params_(params), revision_(0)
+{
+  reset();
+}
+
+void OnlineCalibration::reset()
+{
+  calibration_ = CalibrationData::identity();
+  revision_gyro_bias_ = calibration_.gyro_bias;
+  ++revision_;
+  stationary_ = false;
+  gyro_bias_known_ = false;
+  window_count_ = 0;
+
+  // Both fits start from a sphere of the nominal radius centered on the origin. Points are
+  // normalized by that radius so that every parameter is of order 1.
+  accel_fit_.reset({ { { 1 }, { 1 }, { 1 }, { 0 }, { 0 }, { 0 } } }, kPriorVariance);
+  mag_fit_.reset(
+    { { { 1 }, { 1 }, { 1 }, { 0 }, { 0 }, { 0 }, { 0 }, { 0 }, { 0 } } }, kPriorVariance);
+  accel_coverage_.reset();
+  mag_coverage_.reset();
+
+  // Infinitely far, so the first point is always accepted
+  last_accel_point_ = { INFINITY, INFINITY, INFINITY };
+  last_mag_point_ = { INFINITY, INFINITY, INFINITY };
+}
+
+void OnlineCalibration::setCalibration(const CalibrationData& calibration)
+{
+  calibration_ = calibration;
+  gyro_bias_known_ = calibration.valid & CalibrationData::kGyroValid;
+  revision_gyro_bias_ = calibration.gyro_bias;
+  ++revision_;
+}
+
+const CalibrationData& OnlineCalibration::getCalibration() const
+{
+  return calibration_;
+}
+
+uint32_t OnlineCalibration::getRevision() const
+{
+  return revision_;
+}
+
+bool OnlineCalibration::isStationary() const
+{
+  return stationary_;
+}
+
+void OnlineCalibration::update(std::span<const ImuSample> samples)
+{
+  for (const auto& s : samples)
+  {
+    if (window_count_ == 0)
+    {
+      window_start_ = s.timestamp;
+      for (size_t i = 0; i < 3; ++i)
+        gyro_sum_[i] = gyro_square_sum_[i] = accel_sum_[i] = accel_square_sum_[i] = 0;
+    }
+
+    const float gyro[3] = { s.gx, s.gy, s.gz };
+    const float accel[3] = { s.ax, s.ay, s.az };
+    for (size_t i = 0; i < 3; ++i)
+    {
+      gyro_sum_[i] += gyro[i];
+      gyro_square_sum_[i] += double(gyro[i]) * gyro[i];
+      accel_sum_[i] += accel[i];
+      accel_square_sum_[i] += double(accel[i]) * accel[i];
+    }
+    ++window_count_;
+
+    if (s.timestamp - window_start_ >= params_.window_ns)
+    {
+      closeWindow();
+      window_count_ = 0;
+    }
+  }
+}
+
+void OnlineCalibration::closeWindow()
+{
+  if (window_count_ < kMinWindowSamples)
+  {
+    return;
+  }
+
+  Vec3 gyro_mean = { 0, 0, 0 }, accel_mean = { 0, 0, 0 };
+  bool stationary = true;
+  for (size_t i = 0; i < 3; ++i)
+  {
+    gyro_mean[i] = gyro_sum_[i] / window_count_;
+    accel_mean[i] = accel_sum_[i] / window_count_;
+    const double gyro_variance = gyro_square_sum_[i] / window_count_ - gyro_mean[i] * gyro_mean[i];
+    const double accel_variance =
+      accel_square_sum_[i] / window_count_ - accel_mean[i] * accel_mean[i];
+    stationary &= gyro_variance < params_.gyro_stationary_std * params_.gyro_stationary_std
+                  && accel_variance < params_.accel_stationary_std * params_.accel_stationary_std;
+  }
+
+  stationary_ = stationary;
+  if (!stationary)
+  {
+    return;
+  }
+
+  // A steady rotation has little variance too, so the mean must also be close to the bias
+  const Vec3 reference = gyro_bias_known_ ? calibration_.gyro_bias : Vec3{ 0, 0, 0 };
+  if ((gyro_mean - reference).norm() < params_.max_gyro_bias)
+  {
+    const float gain = gyro_bias_known_ ? params_.gyro_bias_gain : 1.f;
+    calibration_.gyro_bias += (gyro_mean - calibration_.gyro_bias) * gain;
+    calibration_.valid |= CalibrationData::kGyroValid;
+
+    // Every stationary window refines the bias a little, only a real change is a new revision
+    if (!gyro_bias_known_
+        || (calibration_.gyro_bias - revision_gyro_bias_).norm() > params_.gyro_bias_tolerance)
+    {
+      revision_gyro_bias_ = calibration_.gyro_bias;
+      ++revision_;
+    }
+    gyro_bias_known_ = true;
+  }
+
+  updateAccel(accel_mean);
+}
+
+void OnlineCalibration::updateAccel(const Vec3& mean)
+{
+  const Vec3 u = mean * (1 / kGravity);
+  if (!((u - last_accel_point_).norm() >= params_.point_spacing))  // Also drops NaN
+  {
+    return;
+  }
+  last_accel_point_ = u;
+  accel_coverage_.add(u);
+
+  // A ux^2 + B uy^2 + C uz^2 + D ux + E uy + F uz = 1, so d(y) = 2 d(u) for noise in u
+  const float noise = 4 * params_.accel_noise * params_.accel_noise;
+  accel_fit_.update({ { { u.x * u.x }, { u.y * u.y }, { u.z * u.z }, { u.x }, { u.y }, { u.z } } },
+                    1, noise);
+
+  if (accel_coverage_.spans(kCoverage))
+    fitAccel();
+}
+
+void OnlineCalibration::fitAccel()
+{
+  const auto& theta = accel_fit_.getTheta();
+
+  // Completing the squares gives sum A_i (u_i - o_i)^2 = 1 + sum A_i o_i^2 = G
+  Vec3 offset = { 0, 0, 0 }, scale = { 0, 0, 0 };
+  float g = 1;
+  for (size_t i = 0; i < 3; ++i)
+  {
+    if (!(theta[i][0] > 0))
+    {
+      return;
+    }
+    offset[i] = -theta[i + 3][0] / (2 * theta[i][0]);
+    g += theta[i][0] * offset[i] * offset[i];
+  }
+  for (size_t i = 0; i < 3; ++i)
+    scale[i] = std::sqrt(theta[i][0] / g);
+
+  calibration_.accel_offset = offset * kGravity;
+  calibration_.accel_scale = scale;
+  calibration_.valid |= CalibrationData::kAccelValid;
+  ++revision_;
+}
+
+void OnlineCalibration::updateMagnetometer(const Vec3& mag)
+{
+  const Vec3 u = mag * (1 / params_.nominal_field);
+  if (!((u - last_mag_point_).norm() >= params_.point_spacing))  // Also drops NaN
+  {
+    return;
+  }
+  last_mag_point_ = u;
+  mag_coverage_.add(u);
+
+  // u^T M u + 2 b^T u = 1 with M symmetric: A, B, C on the diagonal, D, E, F off it
+  const float noise = 4 * params_.mag_noise * params_.mag_noise;
+  mag_fit_.update({ { { u.x * u.x },
+                      { u.y * u.y },
+                      { u.z * u.z },
+                      { 2 * u.x * u.y },
+                      { 2 * u.x * u.z },
+                      { 2 * u.y * u.z },
+                      { 2 * u.x },
+                      { 2 * u.y },
+                      { 2 * u.z } } },
+                  1, noise);
+
+  if (mag_coverage_.spans(kCoverage))
+    fitMag();
+}
+
+void OnlineCalibration::fitMag()
+{
+  const auto& theta = mag_fit_.getTheta();
+  const Mat<3, 3> m = { { { theta[0][0], theta[3][0], theta[4][0] },
+                          { theta[3][0], theta[1][0], theta[5][0] },
+                          { theta[4][0], theta[5][0], theta[2][0] } } };
+  const Vec3 b = { theta[6][0], theta[7][0], theta[8][0] };
+
+  // Center c = -M^-1 b, then (u - c)^T M (u - c) = 1 + c^T M c = k. M is negative definite,
+  // and k negative, when the origin lies outside the ellipsoid, i.e. when the hard iron offset
+  // exceeds the field; only M / k has to be positive definite.
+  Mat<3, 3> inverse;
+  if (!invert(m, inverse))
+  {
+    return;
+  }
+  const Vec3 center = -(inverse * b);
+  const float k = 1 + center.dot(m * center);
+
+  // (u - c)^T Q (u - c) = 1 with Q = M / k, Q = V L V^T. sqrt(Q) maps the ellipsoid onto the
+  // unit sphere without rotating it; scaling by the geometric mean of the semi-axes, det(Q)^-1/6,
+  // keeps the field strength.
+  Vec3 values;
+  Mat<3, 3> vectors;
+  symmetricEigen(m * (1 / k), values, vectors);
+  if (!(values.x > 0 && values.y > 0 && values.z > 0))
+  {
+    return;
+  }
+  const float radius = std::pow(values.x * values.y * values.z, -1.f / 6);
+
+  Mat<3, 3> scaled = vectors;
+  for (size_t i = 0; i < 3; ++i)
+  {
+    for (size_t j = 0; j < 3; ++j)
+      scaled[i][j] *= std::sqrt(values[j]) * radius;
+  }
+
+  calibration_.mag_offset = center * params_.nominal_field;
+  calibration_.mag_transform = multiplyTransposed(scaled, vectors);
+  calibration_.valid |= CalibrationData::kMagValid;
+  ++revision_;
+}
+
+void OnlineCalibration::correct(ImuSample& sample) const
+{
+  const auto& c = calibration_;
+  sample.gx -= c.gyro_bias.x;
+  sample.gy -= c.gyro_bias.y;
+  sample.gz -= c.gyro_bias.z;
+  sample.ax = (sample.ax - c.accel_offset.x) * c.accel_scale.x;
+  sample.ay = (sample.ay - c.accel_offset.y) * c.accel_scale.y;
+  sample.az = (sample.az - c.accel_offset.z) * c.accel_scale.z;
+}
+
+Vec3 OnlineCalibration::correctMagnetometer(const Vec3& mag) const
+{
+  return calibration_.mag_transform * (mag - calibration_.mag_offset);
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <span>
+
+#include "./InertialSensor.h"
+#include "./linalg.hpp"
+
+/**
+ * @brief Calibration of an inertial sensor, as estimated by OnlineCalibration and as persisted.
+ * Corrections are gyro - gyro_bias, (accel - accel_offset) * accel_scale per axis and
+ * mag_transform * (mag - mag_offset). Estimates without their valid bit are the identity.
+ */
+struct CalibrationData
+{
+  static constexpr uint32_t kGyroValid = 1 << 0;
+  static constexpr uint32_t kAccelValid = 1 << 1;
+  static constexpr uint32_t kMagValid = 1 << 2;
+
+  uint32_t valid;
+  linalg::Vec3 gyro_bias;           // [rad/s]
+  linalg::Vec3 accel_offset;        // [m/s^2]
+  linalg::Vec3 accel_scale;         // Per axis, 1 is ideal
+  linalg::Vec3 mag_offset;          // Hard iron, magnetometer units
+  linalg::Mat<3, 3> mag_transform;  // Soft iron, determinant 1
+
+  static constexpr CalibrationData identity()
+  {
+    return { 0, { 0, 0, 0 }, { 0, 0, 0 }, { 1, 1, 1 }, { 0, 0, 0 }, linalg::Mat<3, 3>::identity() };
+  }
+};
+
+/**
+ * @brief Recursive least squares for y = phi^T theta, one scalar observation at a time.
+ * The initial theta acts as a prior that keeps the solution defined until the observations
+ * determine every parameter.
+ */
+template <size_t N>
+class RecursiveLeastSquares
+{
+public:
+  using Vector = linalg::Mat<N, 1>;
+
+  /**
+   * @param theta Prior parameters
+   * @param variance Prior variance of every parameter
+   */
+  void reset(const Vector& theta, float variance)
+  {
+    theta_ = theta;
+    covariance_ = linalg::Mat<N, N>::identity() * variance;
+  }
+
+  /**
+   * @param phi Regressors
+   * @param y Observation
+   * @param noise Variance of the observation
+   */
+  void update(const Vector& phi, float y, float noise)
+  {
+    const Vector p_phi = covariance_ * phi;
+    float innovation_variance = noise, prediction = 0;
+    for (size_t i = 0; i < N; ++i)
+    {
+      innovation_variance += phi[i][0] * p_phi[i][0];
+      prediction += phi[i][0] * theta_[i][0];
+    }
+
+    const Vector gain = p_phi * (1 / innovation_variance);
+    theta_ += gain * (y - prediction);
+    covariance_ -= linalg::multiplyTransposed(gain, p_phi);
+    covariance_.symmetrize();
+  }
+
+  const Vector& getTheta() const
+  {
+    return theta_;
+  }
+
+private:
+  Vector theta_;
+  linalg::Mat<N, N> covariance_;
+};
+
+/**
+ * @brief Calibrates an inertial sensor while it is in use.
+ * Raw samples are cut into windows. A window with little gyroscope and accelerometer variance
+ * is stationary: its mean angular velocity updates the gyroscope bias and its mean acceleration
+ * is a point on the accelerometer ellipsoid. Magnetometer readings are points on the magnetometer
+ * ellipsoid. Both ellipsoids are fitted by recursive least squares, the accelerometer one
+ * axis-aligned (offset and scale), the magnetometer one general (hard and soft iron). A fit is
+ * published once its points span every axis. No I/O, and nothing is allocated.
+ */
+class OnlineCalibration
+{
+public:
+  struct Params
+  {
+    uint64_t window_ns = 500000000;     // Length of a stationarity window
+    float gyro_stationary_std = 0.02f;  // [rad/s]
+    float accel_stationary_std = 0.3f;  // [m/s^2]
+    float max_gyro_bias = 0.1f;         // Stationary means beyond it are rotations [rad/s]
+    float gyro_bias_gain = 0.2f;        // Weight of a window once the bias is known
+    float gyro_bias_tolerance = 1e-3f;  // Bias drift that makes a new revision [rad/s]
+    float accel_noise = 0.02f;          // Of a window mean, relative to gravity
+    float nominal_field = 50.f;         // Magnetic field strength, magnetometer units
+    float mag_noise = 0.02f;            // Relative to nominal_field
+    float point_spacing = 0.1f;         // Minimum distance between fitted points, relative
+  };
+
+  explicit OnlineCalibration();
+  explicit OnlineCalibration(const Params& params);
+
+  /** Forget every estimate and start the fits from an ideal sensor.
+   */
+  void reset();
+
+  /** Use a calibration, e.g. a persisted one, until the fits replace it.
+   */
+  void setCalibration(const CalibrationData& calibration);
+  const CalibrationData& getCalibration() const;
+
+  /** Incremented whenever getCalibration() changes noticeably, for persisting it when it does.
+   * Gyroscope bias updates count once the bias has moved by gyro_bias_tolerance since the last
+   * revision.
+   */
+  uint32_t getRevision() const;
+
+  /** Whether the last complete window was stationary.
+   */
+  bool isStationary() const;
+
+  /** Accumulate raw samples in timestamp order.
+   */
+  void update(std::span<const ImuSample> samples);
+
+  /** Accumulate a raw magnetometer reading.
+   */
+  void updateMagnetometer(const linalg::Vec3& mag);
+
+  /** Apply the gyroscope and accelerometer calibration to a raw sample.
+   */
+  void correct(ImuSample& sample) const;
+
+  /** Apply the magnetometer calibration to a raw reading.
+   */
+  linalg::Vec3 correctMagnetometer(const linalg::Vec3& mag) const;
+
+private:
+  /** Smallest and largest value seen on every axis.
+   */
+  struct Coverage
+  {
+    linalg::Vec3 min, max;
+
+    void reset();
+    void add(const linalg::Vec3& point);
+    bool spans(float extent) const;
+  };
+
+  void closeWindow();
+  void updateAccel(const linalg::Vec3& mean);
+  void fitAccel();
+  void fitMag();
+
+  Params params_;
+  CalibrationData calibration_;
+  uint32_t revision_;
+  bool stationary_;
+  bool gyro_bias_known_;
+  linalg::Vec3 revision_gyro_bias_;  // Gyroscope bias as of the last revision
+
+  // Current window, accumulated in double against cancellation in the variance
+  uint64_t window_start_;
+  size_t window_count_;
+  double gyro_sum_[3], gyro_square_sum_[3];
+  double accel_sum_[3], accel_square_sum_[3];
+
+  RecursiveLeastSquares<6> accel_fit_;
+  Coverage accel_coverage_;
+  linalg::Vec3 last_accel_point_;
+
+  RecursiveLeastSquares<9> mag_fit_;
+  Coverage mag_coverage_;
+  linalg::Vec3 last_mag_point_;
+};
@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <cmath>
+
+#include "./ErrorStateEKF.h"
+
+namespace
+{
+using linalg::Mat;
+using linalg::Quat;
+using linalg::Vec3;
+
+constexpr size_t kN = ErrorStateEKF::kStates;
+constexpr size_t kPos = 0, kVel = 3, kAtt = 6, kGyroBias = 9, kAccelBias = 12;
+
+constexpr float kGravity = 9.80665f;        // [m/s^2]
+constexpr double kEarthRadius = 6378137.0;  // WGS84 equatorial radius [m]
+constexpr float kMaxTimeStep = 0.1f;        // [s]
+constexpr uint64_t kCovarianceTimeoutNs = 2000000000;
+}  // namespace
+
+ErrorStateEKF::ErrorStateEKF() : ErrorStateEKF(Params())
+{
+}
+
+ErrorStateEKF::ErrorStateEKF(const Params& params)
+  : params_(params), history_interval_ns_(2 * params.gps_delay_ns / kHistorySize)
+{
+  reset();
+}
+
+void ErrorStateEKF::reset()
+{
+  initialized_ = false;
+  state_ = {};
+  state_.attitude = Quat::identity();
+
+  static constexpr float kInitialSigma[kN] = {
+    10, 10, 10,           // Position [m]
+    1, 1, 1,              // Velocity [m/s]
+    0.1f, 0.1f, 1,        // Attitude, yaw is unobserved until the vehicle accelerates [rad]
+    0.02f, 0.02f, 0.02f,  // Gyroscope bias [rad/s]
+    0.5f, 0.5f, 0.5f,     // Accelerometer bias [m/s^2]
+  };
+  covariance_ = Covariance::zero();
+  for (size_t i = 0; i < kN; ++i)
+    covariance_[i][i] = kInitialSigma[i] * kInitialSigma[i];
+
+  history_count_ = 0;
+  history_head_ = 0;
+  origin_set_ = false;
+  baro_reference_set_ = false;
+  gps_covariance_timestamp_ = 0;
+}
+
+void ErrorStateEKF::initialize(const ImuSample& sample)
+{
+  const float roll = std::atan2(-sample.ay, -sample.az);
+  const float pitch =
+    std::atan2(sample.ax, std::sqrt(sample.ay * sample.ay + sample.az * sample.az));
+
+  state_.timestamp = sample.timestamp;
+  state_.attitude = Quat::fromEuler(roll, pitch, 0);
+  initialized_ = true;
+}
+
+void ErrorStateEKF::predict(const ImuSample& sample)
+{
+  if (!initialized_)
+  {
+    initialize(sample);
+    return;
+  }
+
+  const float elapsed = static_cast<int64_t>(sample.timestamp - state_.timestamp) * 1e-9f;
+  const float dt = std::fmax(0.f, std::fmin(elapsed, kMaxTimeStep));
+  state_.timestamp = sample.timestamp;
+
+  const Vec3 f = Vec3{ sample.ax, sample.ay, sample.az } - state_.accel_bias;
+  const Vec3 w = Vec3{ sample.gx, sample.gy, sample.gz } - state_.gyro_bias;
+
+  const Mat<3, 3> r = state_.attitude.toRotation();
+  const Vec3 a = r * f + Vec3{ 0, 0, kGravity };
+  state_.position += state_.velocity * dt + a * (0.5f * dt * dt);
+  state_.velocity += a * dt;
+  state_.attitude = state_.attitude.integrated(w * dt);
+
+  propagateCovariance(r, f, w, dt);
+
+  const size_t newest = (history_head_ + kHistorySize - 1) % kHistorySize;
+  if (history_count_ == 0 || state_.timestamp - history_[newest].timestamp >= history_interval_ns_)
+  {
+    history_[history_head_] = { state_.timestamp, state_.position, state_.velocity };
+    history_head_ = (history_head_ + 1) % kHistorySize;
+    history_count_ += history_count_ < kHistorySize;
+  }
+}
+
+void ErrorStateEKF::predict(std::span<const ImuSample> samples)
+{
+  for (const auto& sample : samples)
+    predict(sample);
+}
+
+void ErrorStateEKF::propagateCovariance(
+  const Mat<3, 3>& r,
+  const Vec3& f,
+  const Vec3& w,
+  float dt)
+{
+  // F = I + A * dt, with A the Jacobian of the error-state dynamics
+  static constexpr Mat<3, 3> kIdentity = Mat<3, 3>::identity();
+  Covariance jacobian = Covariance::identity();
+  jacobian.setBlock(kPos, kVel, kIdentity * dt);
+  jacobian.setBlock(kVel, kAtt, r * skew(f) * -dt);
+  jacobian.setBlock(kVel, kAccelBias, r * -dt);
+  jacobian.setBlock(kAtt, kAtt, kIdentity - skew(w) * dt);
+  jacobian.setBlock(kAtt, kGyroBias, kIdentity * -dt);
+
+  covariance_ = sandwich(jacobian, covariance_);
+
+  const float noise[4] = {
+    params_.accel_noise * params_.accel_noise * dt,
+    params_.gyro_noise * params_.gyro_noise * dt,
+    params_.gyro_bias_walk * params_.gyro_bias_walk * dt,
+    params_.accel_bias_walk * params_.accel_bias_walk * dt,
+  };
+  for (size_t i = 0; i < 3; ++i)
+  {
+    covariance_[kVel + i][kVel + i] += noise[0];
+    covariance_[kAtt + i][kAtt + i] += noise[1];
+    covariance_[kGyroBias + i][kGyroBias + i] += noise[2];
+    covariance_[kAccelBias + i][kAccelBias + i] += noise[3];
+  }
+}
+
+const ErrorStateEKF::HistoryEntry* ErrorStateEKF::findHistory(uint64_t timestamp) const
+{
+  // Newest entry first, stop at the first one not after the measurement
+  size_t index = history_head_;
+  for (size_t i = 0; i < history_count_; ++i)
+  {
+    index = (index + kHistorySize - 1) % kHistorySize;
+    if (history_[index].timestamp <= timestamp)
+      return &history_[index];
+  }
+  return nullptr;
+}
+
+void ErrorStateEKF::updateGps(const NavPvtPayload& pvt)
+{
+  if (!initialized_ || !pvt.gnssFixOk || pvt.fixType < 3)
+  {
+    return;
+  }
+
+  const HistoryEntry* past = findHistory(pvt.timestamp - params_.gps_delay_ns);
+  if (!past)
+  {
+    return;
+  }
+
+  const double lat = pvt.lat * M_PI / 180;
+  const double lon = pvt.lon * M_PI / 180;
+  if (!origin_set_)
+  {
+    // Place the origin so that the first fix lands on the current estimate
+    origin_lat_ = lat - past->position[0] / kEarthRadius;
+    origin_lon_ = lon - past->position[1] / (kEarthRadius * std::cos(origin_lat_));
+    origin_alt_ = pvt.hMSL + past->position[2];
+    origin_set_ = true;
+  }
+
+  const Vec3 position = {
+    static_cast<float>((lat - origin_lat_) * kEarthRadius),
+    static_cast<float>((lon - origin_lon_) * kEarthRadius * std::cos(origin_lat_)),
+    static_cast<float>(origin_alt_ - pvt.hMSL),
+  };
+  const Vec3 velocity = { static_cast<float>(pvt.velN), static_cast<float>(pvt.velE),
+                          static_cast<float>(pvt.velD) };
+
+  Mat<3, 3> position_noise = Mat<3, 3>::identity(), velocity_noise = Mat<3, 3>::identity();
+  const bool covariance_valid = gps_covariance_timestamp_ != 0
+                                && pvt.timestamp - gps_covariance_timestamp_ < kCovarianceTimeoutNs;
+  if (covariance_valid)
+  {
+    position_noise = gps_position_covariance_;
+    velocity_noise = gps_velocity_covariance_;
+  }
+  else
+  {
+    position_noise *= params_.gps_position_noise * params_.gps_position_noise;
+    velocity_noise *= params_.gps_velocity_noise * params_.gps_velocity_noise;
+  }
+
+  // The error is assumed constant over the delay, so the residual against the past state
+  // corrects the current one
+  update3(kPos, position - past->position, position_noise);
+  update3(kVel, velocity - past->velocity, velocity_noise);
+}
+
+void ErrorStateEKF::updateGpsCovariance(const NavCovPayload& cov)
+{
+  gps_position_covariance_ = { {
+    { float(cov.posCovNN), float(cov.posCovNE), float(cov.posCovND) },
+    { float(cov.posCovNE), float(cov.posCovEE), float(cov.posCovED) },
+    { float(cov.posCovND), float(cov.posCovED), float(cov.posCovDD) },
+  } };
+  gps_velocity_covariance_ = { {
+    { float(cov.velCovNN), float(cov.velCovNE), float(cov.velCovND) },
+    { float(cov.velCovNE), float(cov.velCovEE), float(cov.velCovED) },
+    { float(cov.velCovND), float(cov.velCovED), float(cov.velCovDD) },
+  } };
+  gps_covariance_timestamp_ = cov.timestamp;
+}
+
+void ErrorStateEKF::updateBaro(uint64_t timestamp, float pressure)
+{
+  const HistoryEntry* past = initialized_ ? findHistory(timestamp) : nullptr;
+  if (!past || !(pressure > 0))
+  {
+    return;
+  }
+
+  if (!baro_reference_set_)
+  {
+    baro_reference_pressure_ = pressure;
+    baro_reference_altitude_ = -past->position[2];
+    baro_reference_set_ = true;
+    return;
+  }
+
+  // International standard atmosphere below 11km
+  const float altitude =
+    baro_reference_altitude_
+    + 44330.f * (1 - std::pow(pressure / baro_reference_pressure_, 1 / 5.255f));
+  const float residual = altitude + past->position[2];
+
+  // Scalar update with H = -1 on the down position
+  const size_t d = kPos + 2;
+  const float innovation_variance = covariance_[d][d] + params_.baro_noise * params_.baro_noise;
+  float gain[kN];
+  ErrorVector dx;
+  for (size_t i = 0; i < kN; ++i)
+  {
+    gain[i] = -covariance_[i][d] / innovation_variance;
+    dx[i][0] = gain[i] * residual;
+  }
+
+  float row[kN];
+  std::copy(covariance_[d], covariance_[d] + kN, row);
+  for (size_t i = 0; i < kN; ++i)
+  {
+    for (size_t j = 0; j < kN; ++j)
+      covariance_[i][j] += gain[i] * row[j];  // P -= K H P, with H P = -P[d]
+  }
+  inject(dx);
+}
+
+void ErrorStateEKF::update3(size_t first, const Vec3& residual, const Mat<3, 3>& noise)
+{
+  Mat<3, 3> inverse;
+  if (!invertPositiveDefinite(covariance_.block<3, 3>(first, first) + noise, inverse))
+  {
+    return;
+  }
+
+  // K = P H^T S^-1, where P H^T is the columns first to first + 2 of P
+  const Mat<kN, 3> gain = covariance_.block<kN, 3>(0, first) * inverse;
+
+  // P -= K H P, where H P is the rows first to first + 2 of P
+  covariance_ -= gain * covariance_.block<3, kN>(first, 0);
+  covariance_.symmetrize();
+
+  ErrorVector dx;
+  for (size_t i = 0; i < kN; ++i)
+    dx[i][0] = gain.row(i).dot(residual);
+  inject(dx);
+}
+
+void ErrorStateEKF::inject(const ErrorVector& dx)
+{
+  const auto segment = [&dx](size_t first) -> Vec3 {
+    return { dx[first][0], dx[first + 1][0], dx[first + 2][0] };
+  };
+  state_.position += segment(kPos);
+  state_.velocity += segment(kVel);
+  state_.gyro_bias += segment(kGyroBias);
+  state_.accel_bias += segment(kAccelBias);
+  state_.attitude = state_.attitude.integrated(segment(kAtt));
+}
+
+bool ErrorStateEKF::isInitialized() const
+{
+  return initialized_;
+}
+
+const ErrorStateEKF::State& ErrorStateEKF::getState() const
+{
+  return state_;
+}
+
+float ErrorStateEKF::getVariance(size_t index) const
+{
+  return index < kN ? covariance_[index][index] : 0;
+}
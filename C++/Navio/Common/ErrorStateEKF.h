@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <span>
+
+#include "./InertialSensor.h"
+#include "./linalg.hpp"
+#include "./ubx_payload.hpp"
+
+/**
+ * @brief Error-state extended Kalman filter estimating position, velocity and attitude.
+ * The nominal state is propagated with every IMU sample. Its 15 error states (position, velocity,
+ * attitude, gyroscope bias and accelerometer bias) are corrected by GPS NAV-PVT fixes, weighted by
+ * the latest NAV-COV when available, and by barometric altitude. Matrices are fixed-size members
+ * and nothing is allocated. The filter does no I/O and takes the time of every input from its
+ * timestamp, so a recorded log replays exactly as it ran.
+ *
+ * Frames: NED navigation frame, FRD body frame. Accelerometer samples are specific forces, a level
+ * sensor at rest measures (0, 0, -g).
+ */
+class ErrorStateEKF
+{
+public:
+  static constexpr size_t kStates = 15;
+  static constexpr size_t kHistorySize = 128;  // Past states for delayed measurements
+
+  struct Params
+  {
+    float accel_noise = 0.35f;          // Accelerometer noise density [m/s^2/sqrt(Hz)]
+    float gyro_noise = 0.015f;          // Gyroscope noise density [rad/s/sqrt(Hz)]
+    float accel_bias_walk = 0.003f;     // Accelerometer bias random walk [m/s^3/sqrt(Hz)]
+    float gyro_bias_walk = 0.0001f;     // Gyroscope bias random walk [rad/s^2/sqrt(Hz)]
+    float gps_position_noise = 2.5f;    // Used without a recent NAV-COV [m]
+    float gps_velocity_noise = 0.3f;    // Used without a recent NAV-COV [m/s]
+    float baro_noise = 0.5f;            // Barometric altitude [m]
+    uint64_t gps_delay_ns = 100000000;  // Age of a fix when its NAV-PVT is received
+  };
+
+  struct State
+  {
+    uint64_t timestamp;       // Time of the last IMU sample, CLOCK_MONOTONIC_RAW [ns]
+    linalg::Vec3 position;    // NED from the origin [m]
+    linalg::Vec3 velocity;    // NED [m/s]
+    linalg::Quat attitude;    // Body to NED
+    linalg::Vec3 gyro_bias;   // [rad/s]
+    linalg::Vec3 accel_bias;  // [m/s^2]
+  };
+
+  explicit ErrorStateEKF();
+  explicit ErrorStateEKF(const Params& params);
+
+  /** Forget the state, the next IMU sample initializes the filter again.
+   */
+  void reset();
+
+  /** Propagate with one IMU sample.
+   * The first sample after construction or reset() sets roll and pitch from gravity, yaw is 0.
+   */
+  void predict(const ImuSample& sample);
+
+  /** Propagate with samples in timestamp order, e.g. everything drained from a FIFO.
+   */
+  void predict(std::span<const ImuSample> samples);
+
+  /** Correct position and velocity with a GPS fix, compared with the state at the time of the fix.
+   * Fixes without gnssFixOk or a 3D fix are ignored. The first one anchors the NED origin so that
+   * it agrees with the current position.
+   * Past states are kept kHistorySize times at an interval spanning twice gps_delay_ns, whatever
+   * the IMU rate. A fix older than the oldest of them is ignored.
+   */
+  void updateGps(const NavPvtPayload& pvt);
+
+  /** Weight the following fixes with the covariance reported by the receiver.
+   */
+  void updateGpsCovariance(const NavCovPayload& cov);
+
+  /** Correct the altitude with a pressure reading.
+   * The first reading sets the reference pressure at the current altitude. Like GPS fixes,
+   * readings older than the history of past states are ignored.
+   * @param timestamp Reading time, CLOCK_MONOTONIC_RAW [ns]
+   * @param pressure Pressure [mbar]
+   */
+  void updateBaro(uint64_t timestamp, float pressure);
+
+  bool isInitialized() const;
+  const State& getState() const;
+
+  /** Variance of an error state, in the order position, velocity, attitude, gyroscope bias,
+   * accelerometer bias.
+   */
+  float getVariance(size_t index) const;
+
+private:
+  struct HistoryEntry
+  {
+    uint64_t timestamp;
+    linalg::Vec3 position;
+    linalg::Vec3 velocity;
+  };
+
+  using Covariance = linalg::Mat<kStates, kStates>;
+  using ErrorVector = linalg::Mat<kStates, 1>;
+
+  void initialize(const ImuSample& sample);
+  void propagateCovariance(
+    const linalg::Mat<3, 3>& r,
+    const linalg::Vec3& f,
+    const linalg::Vec3& w,
+    float dt);
+
+  /** The newest past state not after timestamp.
+   * @return nullptr if timestamp precedes the history
+   */
+  const HistoryEntry* findHistory(uint64_t timestamp) const;
+
+  /** Kalman update of 3 measurements of the error states first to first + 2.
+   */
+  void update3(size_t first, const linalg::Vec3& residual, const linalg::Mat<3, 3>& noise);
+  void inject(const ErrorVector& dx);
+
+  Params params_;
+  bool initialized_;
+  State state_;
+  Covariance covariance_;
+
+  HistoryEntry history_[kHistorySize];
+  size_t history_count_;
+  size_t history_head_;  // Next entry to overwrite
+  uint64_t history_interval_ns_;  // Between entries, so that the history spans the GPS delay
+
+  bool origin_set_;
+  double origin_lat_, origin_lon_, origin_alt_;  // [rad, rad, m]
+
+  bool baro_reference_set_;
+  float baro_reference_pressure_;  // [mbar]
+  float baro_reference_altitude_;  // Altitude of the reference pressure, -position[2] [m]
+
+  uint64_t gps_covariance_timestamp_;
+  linalg::Mat<3, 3> gps_position_covariance_;
+  linalg::Mat<3, 3> gps_velocity_covariance_;
+};
@@ -8,9 +8,175 @@
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 
 #include "./I2Cdev.h"
+#include "./Util.h"
+
+using namespace std;
+
+// Bounds of the last transfer issued by the calling thread
+static thread_local uint64_t transfer_start = 0;
+static thread_local uint64_t transfer_end = 0;
+
+I2Cbus& I2Cbus::instance()
+{
+  static I2Cbus bus(I2CDEV);
+  return bus;
+}
+
+I2Cbus::I2Cbus(const char* device) : device_(device), fd_(-1), combined_(false), slave_addr_(-1)
+{
+}
+
+I2Cbus::~I2Cbus()
+{
+  if (fd_ >= 0)
+  {
+    close(fd_);
+  }
+}
+
+bool I2Cbus::open()
+{
+  fd_ = ::open(device_, O_RDWR | O_CLOEXEC);
+  if (fd_ < 0)
+  {
+    fprintf(stderr, "Failed to open device: %s\n", strerror(errno));
+    return false;
+  }
+
+  unsigned long funcs;
+  combined_ = ioctl(fd_, I2C_FUNCS, &funcs) == 0 && (funcs & I2C_FUNC_I2C);
+  slave_addr_ = -1;
+  return true;
+}
+
+bool I2Cbus::select(uint8_t devAddr)
+{
+  if (slave_addr_ == devAddr)
+  {
+    return true;
+  }
+  if (ioctl(fd_, I2C_SLAVE, devAddr) < 0)
+  {
+    fprintf(stderr, "Failed to select device: %s\n", strerror(errno));
+    slave_addr_ = -1;
+    return false;
+  }
+  slave_addr_ = devAddr;
+  return true;
+}
+
+bool I2Cbus::transfer(
+  uint8_t devAddr,
+  const uint8_t* tx,
+  uint16_t tx_length,
+  uint8_t* rx,
+  uint16_t rx_length)
+{
+  // The kernel does not write through the buffers of write segments
+  I2Csegment segments[2];
+  size_t count = 0;
+  if (tx_length > 0)
+    segments[count++] = { devAddr, false, const_cast<uint8_t*>(tx), tx_length };
+  if (rx_length > 0)
+    segments[count++] = { devAddr, true, rx, rx_length };
+
+  return transfer(span<const I2Csegment>(segments, count));
+}
+
+bool I2Cbus::transfer(span<const I2Csegment> segments)
+{
+  if (segments.size() > kMaxSegments)
+  {
+    fprintf(stderr, "Segment count (%zu) > %zu\n", segments.size(), kMaxSegments);
+    return false;
+  }
+
+  lock_guard<mutex> lock(mutex_);
+
+  if (fd_ < 0 && !open())
+  {
+    return false;
+  }
+
+  transfer_start = get_time_ns();
+  const bool ok = combined_ ? transferCombined(segments) : transferSequential(segments);
+  transfer_end = get_time_ns();
+
+  return ok;
+}
+
+bool I2Cbus::transferCombined(span<const I2Csegment> segments)
+{
+  i2c_msg messages[kMaxSegments];
+  for (size_t i = 0; i < segments.size(); ++i)
+  {
+    messages[i].addr = segments[i].devAddr;
+    messages[i].flags = segments[i].read ? I2C_M_RD : 0;
+    messages[i].len = segments[i].length;
+    messages[i].buf = segments[i].data;
+  }
+
+  i2c_rdwr_ioctl_data request = { messages, static_cast<uint32_t>(segments.size()) };
+  const int count = ioctl(fd_, I2C_RDWR, &request);
+  if (count < 0)
+  {
+    fprintf(stderr, "Failed to transfer(%d): %s\n", count, strerror(errno));
+    return false;
+  }
+  else if (static_cast<size_t>(count) != segments.size())
+  {
+    fprintf(stderr, "Short transfer, expected %zu messages, got %d\n", segments.size(), count);
+    return false;
+  }
+
+  return true;
+}
+
+bool I2Cbus::transferSequential(span<const I2Csegment> segments)
+{
+  for (const auto& segment : segments)
+  {
+    if (!select(segment.devAddr))
+    {
+      return false;
+    }
+
+    if (segment.read)
+    {
+      const ssize_t count = read(fd_, segment.data, segment.length);
+      if (count < 0)
+      {
+        fprintf(stderr, "Failed to read device(%zd): %s\n", count, strerror(errno));
+        return false;
+      }
+      else if (count != segment.length)
+      {
+        fprintf(stderr, "Short read  from device, expected %d, got %zd\n", segment.length, count);
+        return false;
+      }
+    }
+    else
+    {
+      const ssize_t count = write(fd_, segment.data, segment.length);
+      if (count < 0)
+      {
+        fprintf(stderr, "Failed to write device(%zd): %s\n", count, strerror(errno));
+        return false;
+      }
+      else if (count != segment.length)
+      {
+        fprintf(stderr, "Short write to device, expected %d, got %zd\n", segment.length, count);
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
 
 /** Default constructor.
  */
@@ -18,6 +184,11 @@ I2Cdev::I2Cdev()
 {
 }
 
+uint64_t I2Cdev::getTimestamp(bool midpoint)
+{
+  return midpoint ? transfer_start + (transfer_end - transfer_start) / 2 : transfer_end;
+}
+
 int8_t I2Cdev::readBit(uint8_t devAddr, uint8_t regAddr, uint8_t bitNum, uint8_t* data)
 {
   uint8_t b;
@@ -89,78 +260,20 @@ int8_t I2Cdev::readWord(uint8_t devAddr, uint8_t regAddr, uint16_t* data)
 
 int8_t I2Cdev::readBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t* data)
 {
-  int8_t count = 0;
-  int fd = open(I2CDEV, O_RDWR);
-
-  if (fd < 0)
-  {
-    fprintf(stderr, "Failed to open device: %s\n", strerror(errno));
-    return (-1);
-  }
-  if (ioctl(fd, I2C_SLAVE, devAddr) < 0)
-  {
-    fprintf(stderr, "Failed to select device: %s\n", strerror(errno));
-    close(fd);
-    return (-1);
-  }
-  if (write(fd, &regAddr, 1) != 1)
-  {
-    fprintf(stderr, "Failed to write reg: %s\n", strerror(errno));
-    close(fd);
-    return (-1);
-  }
-  count = read(fd, data, length);
-
-  if (count < 0)
-  {
-    fprintf(stderr, "Failed to read device(%d): %s\n", count, ::strerror(errno));
-    close(fd);
-    return (-1);
-  }
-  else if (count != length)
+  if (!I2Cbus::instance().transfer(devAddr, &regAddr, 1, data, length))
   {
-    fprintf(stderr, "Short read  from device, expected %d, got %d\n", length, count);
-    close(fd);
     return (-1);
   }
-  close(fd);
-
-  return count;
+  return length;
 }
 
 int8_t I2Cdev::readBytesNoRegAddress(uint8_t devAddr, uint8_t length, uint8_t* data)
 {
-  int8_t count = 0;
-  int fd = open(I2CDEV, O_RDWR);
-
-  if (fd < 0)
-  {
-    fprintf(stderr, "Failed to open device: %s\n", strerror(errno));
-    return (-1);
-  }
-  if (ioctl(fd, I2C_SLAVE, devAddr) < 0)
-  {
-    fprintf(stderr, "Failed to select device: %s\n", strerror(errno));
-    close(fd);
-    return (-1);
-  }
-  count = read(fd, data, length);
-
-  if (count < 0)
-  {
-    fprintf(stderr, "Failed to read device(%d): %s\n", count, ::strerror(errno));
-    close(fd);
-    return (-1);
-  }
-  else if (count != length)
+  if (!I2Cbus::instance().transfer(devAddr, nullptr, 0, data, length))
   {
-    fprintf(stderr, "Short read  from device, expected %d, got %d\n", length, count);
-    close(fd);
     return (-1);
   }
-  close(fd);
-
-  return count;
+  return length;
 }
 
 int8_t I2Cdev::readWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16_t* data)
@@ -258,9 +371,7 @@ bool I2Cdev::writeWord(uint8_t devAddr, uint8_t regAddr, uint16_t data)
 
 bool I2Cdev::writeBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t* data)
 {
-  int8_t count = 0;
   uint8_t buf[128];
-  int fd;
 
   if (length > 127)
   {
@@ -268,43 +379,14 @@ bool I2Cdev::writeBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_
     return (FALSE);
   }
 
-  fd = open(I2CDEV, O_RDWR);
-  if (fd < 0)
-  {
-    fprintf(stderr, "Failed to open device: %s\n", strerror(errno));
-    return (FALSE);
-  }
-  if (ioctl(fd, I2C_SLAVE, devAddr) < 0)
-  {
-    fprintf(stderr, "Failed to select device: %s\n", strerror(errno));
-    close(fd);
-    return (FALSE);
-  }
   buf[0] = regAddr;
   memcpy(buf + 1, data, length);
-  count = write(fd, buf, length + 1);
-  if (count < 0)
-  {
-    fprintf(stderr, "Failed to write device(%d): %s\n", count, ::strerror(errno));
-    close(fd);
-    return (FALSE);
-  }
-  else if (count != length + 1)
-  {
-    fprintf(stderr, "Short write to device, expected %d, got %d\n", length + 1, count);
-    close(fd);
-    return (FALSE);
-  }
-  close(fd);
-
-  return TRUE;
+  return I2Cbus::instance().transfer(devAddr, buf, length + 1, nullptr, 0);
 }
 
 bool I2Cdev::writeWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16_t* data)
 {
-  int8_t count = 0;
   uint8_t buf[128];
-  int i, fd;
 
   // Should do potential byteswap and call writeBytes() really, but that
   // messes with the callers buffer
@@ -315,37 +397,11 @@ bool I2Cdev::writeWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16
     return (FALSE);
   }
 
-  fd = open(I2CDEV, O_RDWR);
-  if (fd < 0)
-  {
-    fprintf(stderr, "Failed to open device: %s\n", strerror(errno));
-    return (FALSE);
-  }
-  if (ioctl(fd, I2C_SLAVE, devAddr) < 0)
-  {
-    fprintf(stderr, "Failed to select device: %s\n", strerror(errno));
-    close(fd);
-    return (FALSE);
-  }
   buf[0] = regAddr;
-  for (i = 0; i < length; ++i)
+  for (int i = 0; i < length; ++i)
   {
     buf[i * 2 + 1] = data[i] >> 8;
     buf[i * 2 + 2] = data[i];
   }
-  count = write(fd, buf, length * 2 + 1);
-  if (count < 0)
-  {
-    fprintf(stderr, "Failed to write device(%d): %s\n", count, ::strerror(errno));
-    close(fd);
-    return (FALSE);
-  }
-  else if (count != length * 2 + 1)
-  {
-    fprintf(stderr, "Short write to device, expected %d, got %d\n", length + 1, count);
-    close(fd);
-    return (FALSE);
-  }
-  close(fd);
-  return TRUE;
+  return I2Cbus::instance().transfer(devAddr, buf, length * 2 + 1, nullptr, 0);
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <cinttypes>
+#include <cstddef>
+#include <mutex>
+#include <span>
 
 #define RASPBERRY_PI_I2C "/dev/i2c-1"
 #define BANANA_PI_I2C "/dev/i2c-2"
@@ -12,11 +15,80 @@
 #define FALSE (0 == 1)
 #endif
 
+/**
+ * @brief One message of a combined I2C transaction.
+ */
+struct I2Csegment
+{
+  uint8_t devAddr;  // I2C slave device address
+  bool read;        // Read into data instead of writing from it
+  uint8_t* data;
+  uint16_t length;
+};
+
+/**
+ * @brief I2C adapter kept open for the lifetime of the process and shared by every driver on it.
+ * Every transfer is a single I2C_RDWR ioctl with repeated starts between its segments. On
+ * adapters without I2C_RDWR the selected slave address is cached, so consecutive transfers to the
+ * same device skip the I2C_SLAVE ioctl. Transfers are serialized, a write followed by a read is
+ * never interleaved with another thread's transfer.
+ */
+class I2Cbus
+{
+  static constexpr size_t kMaxSegments = 42;  // I2C_RDWR_IOCTL_MAX_MSGS
+
+public:
+  /** Bus shared by every I2Cdev call, opened on first use.
+   */
+  static I2Cbus& instance();
+
+  I2Cbus(const I2Cbus&) = delete;
+  I2Cbus& operator=(const I2Cbus&) = delete;
+
+  /** Write tx to the device, then read rx from it with a repeated start.
+   * @param devAddr I2C slave device address
+   * @param tx Bytes to write, nullptr if tx_length is 0
+   * @param rx Buffer to store read data in, nullptr if rx_length is 0
+   * @return Status of the transfer (true = success)
+   */
+  bool
+  transfer(uint8_t devAddr, const uint8_t* tx, uint16_t tx_length, uint8_t* rx, uint16_t rx_length);
+
+  /** Issue every segment in a single I2C_RDWR ioctl, separated by repeated starts.
+   * Segments may address different devices. Adapters without plain I2C support fall back to one
+   * read() or write() per segment, still without other transfers in between.
+   * @return Status of the transfer (true = success)
+   */
+  bool transfer(std::span<const I2Csegment> segments);
+
+private:
+  explicit I2Cbus(const char* device);
+  ~I2Cbus();
+
+  bool open();
+  bool select(uint8_t devAddr);
+  bool transferCombined(std::span<const I2Csegment> segments);
+  bool transferSequential(std::span<const I2Csegment> segments);
+
+  const char* device_;
+  int fd_;
+  bool combined_;   // Adapter supports I2C_RDWR
+  int slave_addr_;  // Currently selected slave, -1 if unknown
+  std::mutex mutex_;
+};
+
 class I2Cdev
 {
 public:
   explicit I2Cdev();
 
+  /** Time of the last transfer issued by the calling thread.
+   * @param midpoint Correct for transfer latency by returning the middle of the transfer instead
+   * of its completion
+   * @return CLOCK_MONOTONIC_RAW [ns]
+   */
+  static uint64_t getTimestamp(bool midpoint = true);
+
   /** Read a single bit from an 8-bit device register.
    * @param devAddr I2C slave device address
    * @param regAddr Register regAddr to read from
@@ -0,0 +1,118 @@
+#include <stdexcept>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+#include "./ImuAcquisition.h"
+
+using namespace std;
+
+GpioEdgeSource::GpioEdgeSource(uint32_t line, const char* chip)
+{
+  const int chip_fd = open(chip, O_RDONLY | O_CLOEXEC);
+  if (chip_fd < 0)
+  {
+    throw runtime_error("Failed to open GPIO chip.");
+  }
+
+  gpioevent_request request;
+  memset(&request, 0, sizeof(gpioevent_request));
+  request.lineoffset = line;
+  request.handleflags = GPIOHANDLE_REQUEST_INPUT;
+  request.eventflags = GPIOEVENT_REQUEST_RISING_EDGE;
+  strncpy(request.consumer_label, "navio-drdy", sizeof(request.consumer_label) - 1);
+
+  const int ret = ioctl(chip_fd, GPIO_GET_LINEEVENT_IOCTL, &request);
+  close(chip_fd);  // The event fd stays valid on its own
+  if (ret < 0)
+  {
+    throw runtime_error("Failed to request GPIO line events.");
+  }
+
+  event_fd_ = request.fd;
+}
+
+GpioEdgeSource::~GpioEdgeSource()
+{
+  close(event_fd_);
+}
+
+bool GpioEdgeSource::wait(int timeout_ms)
+{
+  pollfd pfd = { event_fd_, POLLIN | POLLPRI, 0 };
+  if (poll(&pfd, 1, timeout_ms) <= 0)
+  {
+    return false;
+  }
+
+  // Drain every queued event so a late wake-up does not cause back-to-back reads
+  gpioevent_data events[16];
+  return read(event_fd_, events, sizeof(events)) >= static_cast<ssize_t>(sizeof(gpioevent_data));
+}
+
+ImuAcquisition::ImuAcquisition(InertialSensor& sensor, EdgeSource& edge, Callback on_sample)
+  : sensor_(sensor), edge_(edge), on_sample_(move(on_sample)), running_(false), timeouts_(0)
+{
+}
+
+ImuAcquisition::~ImuAcquisition()
+{
+  stop();
+}
+
+bool ImuAcquisition::start(int priority)
+{
+  if (running_)
+  {
+    return false;
+  }
+
+  running_ = true;
+  thread_ = thread(&ImuAcquisition::run, this);
+
+  if (priority > 0)
+  {
+    sched_param param;
+    param.sched_priority = priority;
+    if (pthread_setschedparam(thread_.native_handle(), SCHED_FIFO, &param) != 0)
+    {
+      stop();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void ImuAcquisition::stop()
+{
+  running_ = false;
+  if (thread_.joinable())
+  {
+    thread_.join();
+  }
+}
+
+uint32_t ImuAcquisition::getTimeouts() const
+{
+  return timeouts_;
+}
+
+void ImuAcquisition::run()
+{
+  while (running_)
+  {
+    if (!edge_.wait(kWaitTimeoutMs))
+    {
+      ++timeouts_;
+      continue;
+    }
+
+    sensor_.update();
+    on_sample_(sensor_);
+  }
+}
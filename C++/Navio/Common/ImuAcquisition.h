@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "./InertialSensor.h"
+
+#define GPIO_CHIP "/dev/gpiochip0"
+
+/**
+ * @brief Source of data-ready edges the acquisition thread sleeps on.
+ */
+class EdgeSource
+{
+public:
+  virtual ~EdgeSource() = default;
+
+  /** Block until the next edge.
+   * @param timeout_ms Maximum time to wait, -1 waits forever
+   * @return True if an edge arrived, false on timeout or error
+   */
+  virtual bool wait(int timeout_ms) = 0;
+};
+
+/**
+ * @brief Rising edges of a GPIO line, delivered by the gpiochip character device.
+ */
+class GpioEdgeSource : public EdgeSource
+{
+public:
+  explicit GpioEdgeSource(uint32_t line, const char* chip = GPIO_CHIP);
+  ~GpioEdgeSource() override;
+
+  bool wait(int timeout_ms) override;
+
+private:
+  int event_fd_;
+};
+
+/**
+ * @brief Dedicated thread that updates an inertial sensor exactly when it signals data-ready.
+ */
+class ImuAcquisition
+{
+  static constexpr int kWaitTimeoutMs = 100;  // Bounds the latency of stop()
+
+public:
+  using Callback = std::function<void(InertialSensor&)>;
+
+  /**
+   * @param sensor Initialized sensor with its data-ready output enabled
+   * @param edge Data-ready edge source
+   * @param on_sample Called from the acquisition thread after every update()
+   */
+  explicit ImuAcquisition(InertialSensor& sensor, EdgeSource& edge, Callback on_sample);
+  ~ImuAcquisition();
+
+  /** Start the acquisition thread.
+   * @param priority SCHED_FIFO priority (1-99), 0 keeps the default scheduling policy
+   * @return False if the thread could not be created or the priority could not be set
+   */
+  bool start(int priority = 0);
+
+  /** Stop and join the acquisition thread.
+   */
+  void stop();
+
+  /** Number of kWaitTimeoutMs waits that ended without a data-ready edge.
+   * A sensor that stopped signalling shows up here; single missed edges at its sample rate do not.
+   */
+  uint32_t getTimeouts() const;
+
+private:
+  void run();
+
+  InertialSensor& sensor_;
+  EdgeSource& edge_;
+  Callback on_sample_;
+
+  std::thread thread_;
+  std::atomic<bool> running_;
+  std::atomic<uint32_t> timeouts_;
+};
@@ -1,8 +1,24 @@
 #pragma once
 
+#include <cinttypes>
+
+#include "./SampleRing.h"
+
+struct ImuSample
+{
+  uint64_t timestamp;  // Acquisition time, CLOCK_MONOTONIC_RAW [ns]
+  float ax, ay, az;    // Acceleration [m/s^2]
+  float gx, gy, gz;    // Angular velocity [rad/s]
+};
+
 class InertialSensor
 {
 public:
+  static constexpr size_t kSampleRingSize = 64;
+  using SampleRingType = SampleRing<ImuSample, kSampleRingSize>;
+
+  virtual ~InertialSensor() = default;
+
   virtual void initialize() = 0;
   virtual bool probe() = 0;
   virtual void update() = 0;
@@ -33,7 +49,44 @@ public:
     *mz = mz_;
   };
 
+  /** Copy the latest accelerometer and gyroscope sample as a whole.
+   * Safe to call from any thread while another one runs update().
+   * @return False if no sample has been acquired yet
+   */
+  bool readSample(ImuSample& sample) const
+  {
+    return samples_.latest(sample);
+  };
+
+  /** Stamp samples with the middle of the SPI transfer instead of its completion.
+   */
+  void setMidpointCorrection(bool enable)
+  {
+    midpoint_correction_ = enable;
+  };
+
+  /** Every published sample, for consumers that must not miss any (estimator, logger, ...).
+   * Samples come from update(), or only from readFifo() while the sensor streams through its
+   * FIFO, so they are always in timestamp order with a single producer.
+   */
+  const SampleRingType& getSamples() const
+  {
+    return samples_;
+  };
+
 protected:
+  /** Publish the sample update() just read, unless the FIFO is the producer.
+   */
+  void publishSample(uint64_t timestamp)
+  {
+    if (!fifo_streaming_)
+      samples_.publish({ timestamp, ax_, ay_, az_, gx_, gy_, gz_ });
+  };
+
+  SampleRingType samples_;
+  bool midpoint_correction_ = true;
+  bool fifo_streaming_ = false;  // readFifo() publishes, update() only refreshes the readings
+
   float temperature;
   float ax_, ay_, az_;
   float gx_, gy_, gz_;
@@ -1,5 +1,6 @@
 #include <cmath>
 #include <cassert>
+#include <algorithm>
 
 #include "MPU9250.h"
 
@@ -222,17 +223,18 @@ returns Factory Trim value
 
 void MPU9250::calib_acc()
 {
-  uint8_t response[4];
+  uint8_t response[3];
   // read current acc scale
   auto temp_scale = WriteReg(MPUREG_ACCEL_CONFIG | READ_FLAG, 0x00);
   set_acc_scale(BITS_FS_8G);
   // ENABLE SELF TEST need modify
   // temp_scale=WriteReg(MPUREG_ACCEL_CONFIG, 0x80>>axis);
 
-  ReadRegs(MPUREG_SELF_TEST_X, response, 4);
-  calib_data[0] = ((response[0] & 11100000) >> 3) | ((response[3] & 00110000) >> 4);
-  calib_data[1] = ((response[1] & 11100000) >> 3) | ((response[3] & 00001100) >> 2);
-  calib_data[2] = ((response[2] & 11100000) >> 3) | ((response[3] & 00000011));
+  // SELF_TEST_X..Z_ACCEL hold one full 8-bit factory trim code per axis
+  ReadRegs(MPUREG_SELF_TEST_X, response, 3);
+  calib_data[0] = response[0];
+  calib_data[1] = response[1];
+  calib_data[2] = response[2];
 
   set_acc_scale(temp_scale);
 }
@@ -268,20 +270,28 @@ void MPU9250::calib_mag()
 
 void MPU9250::update()
 {
-  uint8_t response[21];
-  int16_t bit_data[3];
-  int i;
-
-  // Send I2C command at first
-  WriteReg(MPUREG_I2C_SLV0_ADDR, AK8963_I2C_ADDR | READ_FLAG);  // Set the I2C slave addres of
-                                                                // AK8963 and set for read.
-  WriteReg(MPUREG_I2C_SLV0_REG, AK8963_HXL);  // I2C slave 0 register address from where to begin
-                                              // data transfer
-  WriteReg(MPUREG_I2C_SLV0_CTRL, 0x87);       // Read 7 bytes from the magnetometer
+  uint8_t slv0_cmd[3][2] = {
+    { MPUREG_I2C_SLV0_ADDR, AK8963_I2C_ADDR | READ_FLAG },  // Set the I2C slave addres of
+                                                            // AK8963 and set for read.
+    { MPUREG_I2C_SLV0_REG, AK8963_HXL },  // I2C slave 0 register address from where to begin
+                                          // data transfer
+    { MPUREG_I2C_SLV0_CTRL, 0x87 },       // Read 7 bytes from the magnetometer
+  };
   // must start your read from AK8963A register 0x03 and read seven bytes so that upon read of ST2
   // register 0x09 the AK8963A will unlatch the data registers for the next measurement.
 
-  ReadRegs(MPUREG_ACCEL_XOUT_H, response, 21);
+  uint8_t tx[22] = { MPUREG_ACCEL_XOUT_H | READ_FLAG };
+  uint8_t rx[22] = { 0 };
+  const uint8_t* response = rx + 1;
+  int16_t bit_data[3];
+  int i;
+
+  // Send I2C command at first, then read the sensor block, all in a single ioctl
+  for (auto& cmd : slv0_cmd)
+    spi_dev_.queue(cmd, nullptr, 2);
+  spi_dev_.queue(tx, rx, sizeof(tx));
+  spi_dev_.submit();
+  const uint64_t timestamp = spi_dev_.getTimestamp(midpoint_correction_);
 
   // Get accelerometer value
   for (i = 0; i < 3; ++i)
@@ -313,4 +323,125 @@ void MPU9250::update()
   mx_ = bit_data[0] * magnetometer_ASA[0];
   my_ = bit_data[1] * magnetometer_ASA[1];
   mz_ = bit_data[2] * magnetometer_ASA[2];
+
+  publishSample(timestamp);
+}
+
+/*-----------------------------------------------------------------------------------------------
+                                DATA READY INTERRUPT
+usage: call this function after initialization to drive the INT pin on every new sample, so that
+the sensor can be read from a GPIO edge instead of polling
+-----------------------------------------------------------------------------------------------*/
+
+void MPU9250::enableDataReadyInterrupt(bool enable)
+{
+  WriteReg(MPUREG_INT_ENABLE, enable ? BIT_RAW_RDY_EN : 0x00);
+}
+
+/*-----------------------------------------------------------------------------------------------
+                                    FIFO STREAMING
+usage: call enableFifo() after initialize(), then readFifo() once per control tick to collect
+every accelerometer/gyroscope sample produced since the previous call. Suitable rates are:
+FIFO_RATE_1KHZ
+FIFO_RATE_8KHZ
+-----------------------------------------------------------------------------------------------*/
+
+void MPU9250::enableFifo(fifo_rate_t rate)
+{
+  WriteReg(MPUREG_FIFO_EN, 0x00);
+
+  switch (rate)
+  {
+    case FIFO_RATE_1KHZ:
+      WriteReg(MPUREG_CONFIG, BIT_FIFO_MODE | BITS_DLPF_CFG_188HZ);
+      WriteReg(MPUREG_ACCEL_CONFIG_2, BITS_DLPF_CFG_188HZ);
+      fifo_period_ns_ = 1000000;
+      break;
+    case FIFO_RATE_8KHZ:
+      WriteReg(MPUREG_CONFIG, BIT_FIFO_MODE | BITS_DLPF_CFG_256HZ_NOLPF2);
+      WriteReg(MPUREG_ACCEL_CONFIG_2, BIT_ACCEL_FCHOICE_B);
+      fifo_period_ns_ = 125000;
+      break;
+  }
+  WriteReg(MPUREG_SMPLRT_DIV, 0x00);
+
+  WriteReg(MPUREG_USER_CTRL, BIT_I2C_MST_EN | BIT_FIFO_RST);
+  WriteReg(MPUREG_USER_CTRL, BIT_I2C_MST_EN | BIT_FIFO_EN);
+  WriteReg(MPUREG_FIFO_EN, BITS_FIFO_EN_GYRO | BITS_FIFO_EN_ACCEL);
+  fifo_streaming_ = true;
+}
+
+//-----------------------------------------------------------------------------------------------
+
+void MPU9250::disableFifo()
+{
+  fifo_streaming_ = false;
+  WriteReg(MPUREG_FIFO_EN, 0x00);
+  WriteReg(MPUREG_USER_CTRL, BIT_I2C_MST_EN | BIT_FIFO_RST);
+  WriteReg(MPUREG_CONFIG, 0x00);
+  WriteReg(MPUREG_ACCEL_CONFIG_2, BIT_ACCEL_FCHOICE_B);
+}
+
+//-----------------------------------------------------------------------------------------------
+
+std::span<const ImuSample> MPU9250::readFifo()
+{
+  // Interrupt status and FIFO level in one ioctl
+  uint8_t status_tx[2] = { MPUREG_INT_STATUS | READ_FLAG };
+  uint8_t status_rx[2] = { 0 };
+  uint8_t count_tx[3] = { MPUREG_FIFO_COUNTH | READ_FLAG };
+  uint8_t count_rx[3] = { 0 };
+
+  spi_dev_.queue(status_tx, status_rx, sizeof(status_tx));
+  spi_dev_.queue(count_tx, count_rx, sizeof(count_tx));
+  spi_dev_.submit();
+  const uint64_t now = spi_dev_.getTimestamp(midpoint_correction_);
+
+  // INT_PIN_CFG clears the overflow flag on any register read, e.g. by update(), so a full FIFO
+  // is an overflow too. It stops mid-frame and every later frame would be misaligned.
+  const uint32_t count = ((count_rx[1] & 0x1F) << 8) | count_rx[2];
+  if ((status_rx[1] & BIT_FIFO_OFLOW_INT) || count >= kFifoSize)
+  {
+    // Frames are no longer contiguous in time, start over
+    WriteReg(MPUREG_USER_CTRL, BIT_I2C_MST_EN | BIT_FIFO_EN | BIT_FIFO_RST);
+    return {};
+  }
+
+  // A partially written frame stays in the FIFO until the next call
+  const uint32_t samples = std::min(count / kFifoFrameSize, kFifoMaxSamples);
+  if (samples == 0)
+    return {};
+
+  fifo_tx_[0] = MPUREG_FIFO_R_W | READ_FLAG;
+  spi_dev_.transfer(fifo_tx_, fifo_rx_, 1 + samples * kFifoFrameSize);
+
+  int16_t bit_data[6];
+  for (uint32_t n = 0; n < samples; ++n)
+  {
+    const uint8_t* frame = &fifo_rx_[1 + n * kFifoFrameSize];
+    for (int i = 0; i < 6; ++i)
+    {
+      bit_data[i] = ((int16_t)frame[i * 2] << 8) | frame[i * 2 + 1];
+    }
+
+    auto& sample = fifo_samples_[n];
+    sample.timestamp = now - (samples - 1 - n) * fifo_period_ns_;
+    sample.ax = G_SI * bit_data[0] / acc_divider;
+    sample.ay = G_SI * bit_data[1] / acc_divider;
+    sample.az = G_SI * bit_data[2] / acc_divider;
+    sample.gx = DEG2RAD * bit_data[3] / gyro_divider;
+    sample.gy = DEG2RAD * bit_data[4] / gyro_divider;
+    sample.gz = DEG2RAD * bit_data[5] / gyro_divider;
+    samples_.publish(sample);
+  }
+
+  const auto& latest = fifo_samples_[samples - 1];
+  ax_ = latest.ax;
+  ay_ = latest.ay;
+  az_ = latest.az;
+  gx_ = latest.gx;
+  gy_ = latest.gy;
+  gz_ = latest.gz;
+
+  return { fifo_samples_, samples };
 }
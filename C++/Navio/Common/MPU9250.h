@@ -1,19 +1,53 @@
 #pragma once
 
+#include <span>
+
 #include "./SPIdev.h"
 #include "./InertialSensor.h"
 
 class MPU9250 : public InertialSensor
 {
   static constexpr uint32_t kSpiSpeedHz = 1000000;  // Maximum frequency is 1MHz
+  static constexpr uint32_t kFifoSize = 512;
+  static constexpr uint32_t kFifoFrameSize = 12;  // Accelerometer and gyroscope, 3 x int16 each
+  static constexpr uint32_t kFifoMaxSamples = kFifoSize / kFifoFrameSize;
 
 public:
+  enum fifo_rate_t
+  {
+    FIFO_RATE_1KHZ,  // DLPF 184Hz
+    FIFO_RATE_8KHZ,  // Gyroscope DLPF 250Hz, accelerometer DLPF bypassed and updating at 4kHz
+  };
+
   explicit MPU9250();
 
   void initialize() override;
   bool probe() override;
   void update() override;
 
+  /** Raise INT (NAVIO_MPU9250_DRDY) whenever a new sample is ready.
+   * The line is latched high until any register is read.
+   */
+  void enableDataReadyInterrupt(bool enable = true);
+
+  /** Stream accelerometer and gyroscope samples through the hardware FIFO.
+   * The FIFO holds 42 samples, so at 8kHz it must be drained at 250Hz or faster.
+   * Call after initialize(). Magnetometer and temperature are still read by update(), which then
+   * stops publishing samples: getSamples() receives the FIFO samples from readFifo() only.
+   * @param rate FIFO sample rate
+   */
+  void enableFifo(fifo_rate_t rate = FIFO_RATE_1KHZ);
+
+  /** Stop streaming and restore the default sampling configuration.
+   */
+  void disableFifo();
+
+  /** Drain the FIFO with a single burst read.
+   * On overflow, or once the FIFO is full, the FIFO is reset and no samples are returned.
+   * @return Samples received since the previous call, oldest first. Valid until the next call.
+   */
+  std::span<const ImuSample> readFifo();
+
 private:
   uint8_t WriteReg(uint8_t WriteAddr, uint8_t WriteData);
   uint8_t ReadReg(uint8_t ReadAddr);
@@ -32,6 +66,11 @@ private:
 
   int calib_data[3];
   float magnetometer_ASA[3];
+
+  uint64_t fifo_period_ns_;
+  uint8_t fifo_tx_[1 + kFifoMaxSamples * kFifoFrameSize] = { 0 };
+  uint8_t fifo_rx_[1 + kFifoMaxSamples * kFifoFrameSize] = { 0 };
+  ImuSample fifo_samples_[kFifoMaxSamples];
 };
 
 // MPU9250 registers
@@ -87,6 +126,7 @@ private:
 #define MPUREG_I2C_MST_STATUS 0x36
 #define MPUREG_INT_PIN_CFG 0x37
 #define MPUREG_INT_ENABLE 0x38
+#define MPUREG_INT_STATUS 0x3A
 #define MPUREG_ACCEL_XOUT_H 0x3B
 #define MPUREG_ACCEL_XOUT_L 0x3C
 #define MPUREG_ACCEL_YOUT_H 0x3D
@@ -209,6 +249,14 @@ private:
 #define BIT_INT_ANYRD_2CLEAR 0x10
 #define BIT_RAW_RDY_EN 0x01
 #define BIT_I2C_IF_DIS 0x10
+#define BIT_FIFO_MODE 0x40
+#define BIT_FIFO_EN 0x40
+#define BIT_I2C_MST_EN 0x20
+#define BIT_FIFO_RST 0x04
+#define BIT_FIFO_OFLOW_INT 0x10
+#define BITS_FIFO_EN_GYRO 0x70
+#define BITS_FIFO_EN_ACCEL 0x08
+#define BIT_ACCEL_FCHOICE_B 0x08
 
 #define READ_FLAG 0x80
 
@@ -1,9 +1,38 @@
-#include <math.h>
 #include <unistd.h>
+#ifdef MS5611_FLOAT_COMPENSATION
+#include <math.h>
+#endif
 
 #include "./MS5611.h"
+#include "./Util.h"
+
+// Maximum conversion time for each oversampling ratio [ns]
+static uint64_t conversionTime(ms5611_osr_t osr)
+{
+  switch (osr)
+  {
+    case MS5611_OSR_256:
+      return 600000;
+    case MS5611_OSR_512:
+      return 1170000;
+    case MS5611_OSR_1024:
+      return 2280000;
+    case MS5611_OSR_2048:
+      return 4540000;
+    default:
+      return 9040000;
+  }
+}
 
 MS5611::MS5611(uint8_t address)
+  : conversionStart(0),
+    pressureOsr(MS5611_OSR_4096),
+    timestamp(0),
+    tickState(Idle),
+    conversionEnd(0),
+    osr(MS5611_OSR_4096),
+    temperatureRatio(1),
+    pressureCount(0)
 {
   devAddr = address;
 }
@@ -38,6 +67,8 @@ bool MS5611::testConnection()
 void MS5611::refreshPressure(uint8_t OSR)
 {
   I2Cdev::writeBytes(devAddr, OSR, 0, 0);
+  conversionStart = I2Cdev::getTimestamp(false);
+  pressureOsr = static_cast<ms5611_osr_t>(OSR - MS5611_RA_D1_OSR_256);
 }
 
 void MS5611::readPressure()
@@ -45,6 +76,8 @@ void MS5611::readPressure()
   uint8_t buffer[3];
   I2Cdev::readBytes(devAddr, MS5611_RA_ADC, 3, buffer);
   D1 = (buffer[0] << 16) | (buffer[1] << 8) | buffer[2];
+  // The read may come long after the conversion finished, only its duration is known
+  timestamp = conversionStart + conversionTime(pressureOsr) / 2;
 }
 
 void MS5611::refreshTemperature(uint8_t OSR)
@@ -59,6 +92,54 @@ void MS5611::readTemperature()
   D2 = (buffer[0] << 16) | (buffer[1] << 8) | buffer[2];
 }
 
+void MS5611::compensate(const uint16_t (&C)[6], uint32_t D1, uint32_t D2, int32_t& temperature,
+                        int32_t& pressure)
+{
+  const auto [C1, C2, C3, C4, C5, C6] = C;
+
+  // First order compensation, exactly as the datasheet's integer algorithm
+  const int32_t dT = int32_t(D2) - (int32_t(C5) << 8);
+  int32_t temp = 2000 + int32_t((int64_t(dT) * C6) >> 23);
+  int64_t off = (int64_t(C2) << 16) + ((int64_t(C4) * dT) >> 7);
+  int64_t sens = (int64_t(C1) << 15) + ((int64_t(C3) * dT) >> 8);
+
+  // Second order compensation below 20 degrees
+  if (temp < 2000)
+  {
+    const int64_t low = int64_t(temp - 2000) * (temp - 2000);
+    int64_t off2 = (5 * low) >> 1;
+    int64_t sens2 = (5 * low) >> 2;
+
+    if (temp < -1500)
+    {
+      const int64_t very_low = int64_t(temp + 1500) * (temp + 1500);
+      off2 += 7 * very_low;
+      sens2 += (11 * very_low) >> 1;
+    }
+
+    temp -= int32_t((int64_t(dT) * dT) >> 31);
+    off -= off2;
+    sens -= sens2;
+  }
+
+  temperature = temp;
+  pressure = int32_t((((int64_t(D1) * sens) >> 21) - off) >> 15);
+}
+
+#ifndef MS5611_FLOAT_COMPENSATION
+
+void MS5611::calculatePressureAndTemperature()
+{
+  int32_t temp, pres;
+  compensate({ C1, C2, C3, C4, C5, C6 }, D1, D2, temp, pres);
+
+  // 0.01 mbar and 0.01 degrees
+  PRES = pres / 100.0f;
+  TEMP = temp / 100.0f;
+}
+
+#else
+
 void MS5611::calculatePressureAndTemperature()
 {
   float dT = D2 - C5 * pow(2, 8);
@@ -95,6 +176,8 @@ void MS5611::calculatePressureAndTemperature()
   TEMP = TEMP / 100;
 }
 
+#endif
+
 void MS5611::update()
 {
   refreshPressure();
@@ -108,6 +191,62 @@ void MS5611::update()
   calculatePressureAndTemperature();
 }
 
+void MS5611::configure(ms5611_osr_t osr, uint8_t temperatureRatio)
+{
+  this->osr = osr;
+  this->temperatureRatio = temperatureRatio > 0 ? temperatureRatio : 1;
+  tickState = Idle;  // Discard the conversion in progress, it may use the previous OSR
+}
+
+bool MS5611::tick()
+{
+  if (tickState != Idle && get_time_ns() < conversionEnd)
+  {
+    return false;
+  }
+
+  switch (tickState)
+  {
+    case Idle:
+      // Pressure compensation needs a temperature first
+      pressureCount = 0;
+      startConversion(ConvertingTemperature);
+      return false;
+
+    case ConvertingTemperature:
+      readTemperature();
+      startConversion(ConvertingPressure);
+      return false;
+
+    case ConvertingPressure:
+      readPressure();
+      if (++pressureCount >= temperatureRatio)
+      {
+        pressureCount = 0;
+        startConversion(ConvertingTemperature);
+      }
+      else
+      {
+        startConversion(ConvertingPressure);
+      }
+      calculatePressureAndTemperature();
+      return true;
+  }
+
+  return false;
+}
+
+void MS5611::startConversion(TickState next)
+{
+  if (next == ConvertingPressure)
+    refreshPressure(MS5611_RA_D1_OSR_256 + osr);
+  else
+    refreshTemperature(MS5611_RA_D2_OSR_256 + osr);
+
+  conversionEnd = I2Cdev::getTimestamp(false) + conversionTime(osr);
+  tickState = next;
+}
+
 float MS5611::getTemperature()
 {
   return TEMP;
@@ -117,3 +256,8 @@ float MS5611::getPressure()
 {
   return PRES;
 }
+
+uint64_t MS5611::getTimestamp()
+{
+  return timestamp;
+}
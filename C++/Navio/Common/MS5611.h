@@ -30,6 +30,16 @@
 #define MS5611_RA_D2_OSR_2048 0x56
 #define MS5611_RA_D2_OSR_4096 0x58
 
+// Oversampling ratio, offset from the D1/D2 conversion commands
+enum ms5611_osr_t : uint8_t
+{
+  MS5611_OSR_256 = 0x00,
+  MS5611_OSR_512 = 0x02,
+  MS5611_OSR_1024 = 0x04,
+  MS5611_OSR_2048 = 0x06,
+  MS5611_OSR_4096 = 0x08,
+};
+
 class MS5611
 {
 public:
@@ -71,14 +81,40 @@ public:
 
   /** Calculate temperature and pressure calculations and perform compensation
    *  More info about these calculations is available in the datasheet.
+   *  Uses the datasheet's 64-bit integer algorithm, define MS5611_FLOAT_COMPENSATION to use the
+   *  previous floating point implementation instead.
    */
   void calculatePressureAndTemperature();
 
+  /** The datasheet's integer compensation with second order correction.
+   * @param C PROM coefficients C1..C6
+   * @param D1 Raw pressure
+   * @param D2 Raw temperature
+   * @param temperature Temperature [0.01 degrees of Celsius]
+   * @param pressure Pressure [0.01 mbar]
+   */
+  static void compensate(const uint16_t (&C)[6], uint32_t D1, uint32_t D2, int32_t& temperature,
+                         int32_t& pressure);
+
   /** Perform pressure and temperature reading and calculation at once.
    *  Contains sleeps, better perform operations separately.
    */
   void update();
 
+  /** Configure the acquisition driven by tick().
+   * @param osr Oversampling ratio of both conversions
+   * @param temperatureRatio Pressure conversions per temperature conversion (at least 1)
+   */
+  void configure(ms5611_osr_t osr = MS5611_OSR_4096, uint8_t temperatureRatio = 1);
+
+  /** Advance the acquisition without blocking.
+   * Starts a conversion, or collects it once its conversion time has elapsed and immediately
+   * starts the next one. Call it from an existing loop at any rate, at OSR 4096 new pressure
+   * values arrive at up to ~100Hz.
+   * @return True if a new pressure value has been calculated
+   */
+  bool tick();
+
   /** Get calculated temperature value
    @return Temperature in degrees of Celsius
    */
@@ -89,10 +125,36 @@ public:
  */
   float getPressure();
 
+  /** Get acquisition time of the pressure value
+   @return Middle of the last pressure conversion, CLOCK_MONOTONIC_RAW [ns]
+   */
+  uint64_t getTimestamp();
+
 private:
   uint8_t devAddr;                  // I2C device adress
   uint16_t C1, C2, C3, C4, C5, C6;  // Calibration data
   uint32_t D1, D2;                  // Raw measurement data
   float TEMP;                       // Calculated temperature
   float PRES;                       // Calculated pressure
+  uint64_t conversionStart;         // End of the last pressure conversion command
+  ms5611_osr_t pressureOsr;         // Oversampling ratio of the last pressure conversion
+  uint64_t timestamp;               // Pressure acquisition time
+
+  enum TickState
+  {
+    Idle,
+    ConvertingTemperature,
+    ConvertingPressure,
+  };
+
+  TickState tickState;       // Conversion in progress
+  uint64_t conversionEnd;    // Time the conversion in progress is ready to be read
+  ms5611_osr_t osr;          // Oversampling ratio used by tick()
+  uint8_t temperatureRatio;  // Pressure conversions per temperature conversion
+  uint8_t pressureCount;     // Pressure conversions since the last temperature conversion
+
+  /** Start the next conversion for tick() and note when it will be ready.
+   * @param next ConvertingTemperature or ConvertingPressure
+   */
+  void startConversion(TickState next);
 };
@@ -0,0 +1,101 @@
+#include <cmath>
+
+#include "./MahonyFilter.h"
+
+using linalg::Quat;
+using linalg::Vec3;
+
+MahonyFilter::MahonyFilter(float kp, float ki) : bias_{ 0, 0, 0 }
+{
+  setGains(kp, ki);
+  reset();
+}
+
+void MahonyFilter::setGains(float kp, float ki)
+{
+  two_kp_ = 2 * kp;
+  two_ki_ = 2 * ki;
+}
+
+void MahonyFilter::setGyroBias(float bx, float by, float bz)
+{
+  bias_ = { bx, by, bz };
+}
+
+void MahonyFilter::reset()
+{
+  attitude_ = Quat::identity();
+  integral_ = { 0, 0, 0 };
+  timestamp_ = 0;
+}
+
+void MahonyFilter::update(std::span<const ImuSample> samples)
+{
+  if (samples.empty())
+  {
+    return;
+  }
+
+  size_t first = 0;
+  if (timestamp_ == 0)
+  {
+    timestamp_ = samples[0].timestamp;
+    first = 1;
+  }
+
+  // Work on locals so the compiler keeps the state in registers across the whole batch
+  Quat q = attitude_;
+  Vec3 integral = integral_;
+  uint64_t previous = timestamp_;
+
+  for (size_t i = first; i < samples.size(); ++i)
+  {
+    const ImuSample& s = samples[i];
+    const float elapsed = static_cast<int64_t>(s.timestamp - previous) * 1e-9f;
+    const float dt = std::fmax(0.f, std::fmin(elapsed, kMaxTimeStep));
+    previous = s.timestamp;
+
+    // A zero accelerometer vector (free fall, missing data) gives no correction instead of NaN
+    const Vec3 accel = Vec3{ s.ax, s.ay, s.az }.normalized();
+
+    // Error is the cross product between measured and estimated half direction of gravity
+    const Vec3 half_gravity = q.toRotation().row(2) * 0.5f;
+    const Vec3 error = accel.cross(half_gravity);
+
+    // Integral feedback stays 0 while Ki is 0
+    integral += error * (two_ki_ * dt);
+
+    const Vec3 rate = Vec3{ s.gx, s.gy, s.gz } - bias_ + integral + error * two_kp_;
+    q = q.integrated(rate * dt);
+  }
+
+  attitude_ = q;
+  integral_ = integral;
+  timestamp_ = previous;
+}
+
+const linalg::Quat& MahonyFilter::getAttitude() const
+{
+  return attitude_;
+}
+
+void MahonyFilter::getQuaternion(float* w, float* x, float* y, float* z) const
+{
+  *w = attitude_.w;
+  *x = attitude_.x;
+  *y = attitude_.y;
+  *z = attitude_.z;
+}
+
+void MahonyFilter::getEuler(float* roll, float* pitch, float* yaw) const
+{
+  const Vec3 euler = attitude_.toEuler();
+  *roll = euler.x;
+  *pitch = euler.y;
+  *yaw = euler.z;
+}
+
+uint64_t MahonyFilter::getTimestamp() const
+{
+  return timestamp_;
+}
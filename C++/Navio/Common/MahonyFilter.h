@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cinttypes>
+#include <span>
+
+#include "./InertialSensor.h"
+#include "./linalg.hpp"
+
+/**
+ * @brief Mahony complementary filter estimating attitude from accelerometer and gyroscope.
+ * Samples are passed in batches, e.g. everything drained from a FIFO or a SampleRing since the
+ * previous call, and integrated in one loop with the time step taken from their timestamps. The
+ * filter does no sensor I/O.
+ */
+class MahonyFilter
+{
+  static constexpr float kMaxTimeStep = 0.1f;  // [s], bounds the step after a gap in the samples
+
+public:
+  /**
+   * @param kp Proportional gain of the accelerometer correction
+   * @param ki Integral gain of the accelerometer correction, 0 disables it
+   */
+  explicit MahonyFilter(float kp = 1.f, float ki = 0.f);
+
+  void setGains(float kp, float ki);
+
+  /** Angular velocity subtracted from every gyroscope sample [rad/s].
+   */
+  void setGyroBias(float bx, float by, float bz);
+
+  /** Restart from the identity attitude with no integral feedback.
+   */
+  void reset();
+
+  /** Integrate a batch of samples in timestamp order.
+   * The first sample after construction or reset() only starts the clock.
+   */
+  void update(std::span<const ImuSample> samples);
+
+  /** Attitude as a unit quaternion rotating body vectors into the reference frame.
+   */
+  const linalg::Quat& getAttitude() const;
+  void getQuaternion(float* w, float* x, float* y, float* z) const;
+
+  /** Attitude as roll, pitch and yaw [rad].
+   */
+  void getEuler(float* roll, float* pitch, float* yaw) const;
+
+  /** Timestamp of the last integrated sample, 0 before the first one [ns].
+   */
+  uint64_t getTimestamp() const;
+
+private:
+  float two_kp_, two_ki_;
+  linalg::Vec3 bias_;
+  linalg::Quat attitude_;
+  linalg::Vec3 integral_;
+  uint64_t timestamp_;
+};
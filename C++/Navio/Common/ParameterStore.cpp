@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include "./ParameterStore.h"
+
+namespace
+{
+constexpr uint32_t kMagic = 0x5350564e;  // "NVPS"
+constexpr uint16_t kFormat = 2;
+constexpr size_t kAlignment = 16;  // Slot capacities are rounded up to it, leaving room to grow
+
+struct CrcTable
+{
+  uint32_t values[256];
+
+  constexpr CrcTable() : values()
+  {
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k)
+        c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+      values[i] = c;
+    }
+  }
+};
+
+constexpr CrcTable kCrcTable;
+
+/* CRC-32 (IEEE 802.3), continuing from the crc of the preceding bytes */
+uint32_t crc32(const void* data, size_t length, uint32_t crc = 0)
+{
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < length; ++i)
+    crc = kCrcTable.values[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+  return ~crc;
+}
+
+/* Sequence numbers compare modulo 2^32 */
+bool isNewer(uint32_t a, uint32_t b)
+{
+  return static_cast<int32_t>(a - b) > 0;
+}
+}  // namespace
+
+ParameterStore::ParameterStore(Storage& storage)
+  : storage_(storage), open_(false), directory_(), directory_copy_(1)
+{
+  static_assert(kRecordsOffset + 2 * kSlotSize <= Storage::kSize);
+}
+
+bool ParameterStore::open()
+{
+  open_ = false;
+  Directory copies[2];
+  if (!storage_.read(0, { reinterpret_cast<uint8_t*>(copies), sizeof(copies) }))
+  {
+    return false;
+  }
+
+  // The newest valid copy, the other one may hold a directory write cut short
+  int newest = -1;
+  for (int copy = 0; copy < 2; ++copy)
+  {
+    if (isValid(copies[copy])
+        && (newest < 0 || isNewer(copies[copy].sequence, copies[newest].sequence)))
+      newest = copy;
+  }
+  if (newest < 0)
+  {
+    fprintf(stderr, "No parameter store found\n");
+    return false;
+  }
+
+  directory_ = copies[newest];
+  directory_copy_ = newest;
+  for (auto& slot : slots_)
+    slot = {};
+  open_ = true;
+  return true;
+}
+
+bool ParameterStore::format()
+{
+  memset(&directory_, 0, sizeof(Directory));
+  directory_.magic = kMagic;
+  directory_.format = kFormat;
+  for (auto& slot : slots_)
+    slot = {};
+
+  // Both copies, neither may keep an older directory that open() would prefer
+  open_ = writeDirectory() && writeDirectory();
+  return open_;
+}
+
+bool ParameterStore::load(uint16_t key, uint16_t version, std::span<uint8_t> data)
+{
+  const int index = open_ ? find(key) : -1;
+  if (index < 0 || !scan(index) || !slots_[index].valid)
+  {
+    return false;
+  }
+
+  const Entry& entry = directory_.entries[index];
+  const uint8_t* slot = buffer_ + slots_[index].newest * (sizeof(SlotHeader) + entry.capacity);
+  SlotHeader header;
+  memcpy(&header, slot, sizeof(SlotHeader));
+  if (header.version != version || header.length != data.size())
+  {
+    return false;
+  }
+
+  memcpy(data.data(), slot + sizeof(SlotHeader), header.length);
+  return true;
+}
+
+bool ParameterStore::save(uint16_t key, uint16_t version, std::span<const uint8_t> data)
+{
+  if (!open_ || data.size() > kMaxRecordSize)
+  {
+    return false;
+  }
+
+  // A record that outgrew its slots moves to fresh ones, referenced only once its data is there
+  int index = find(key);
+  const bool moving = index < 0 || data.size() > directory_.entries[index].capacity;
+  Entry entry;
+  SlotState state = { true, false, 0, 0 };
+  if (moving)
+  {
+    if (!allocate(key, data.size(), entry))
+    {
+      return false;
+    }
+  }
+  else
+  {
+    if (!slots_[index].scanned && !scan(index))
+    {
+      return false;
+    }
+    entry = directory_.entries[index];
+    state = slots_[index];
+  }
+
+  // Overwrite the slot not holding the newest copy, which stays valid if this write is torn
+  const uint8_t target = state.valid ? 1 - state.newest : 0;
+
+  SlotHeader header = { state.valid ? state.sequence + 1 : 1, version,
+                        static_cast<uint16_t>(data.size()), 0 };
+  header.crc = checksum(header, data.data());
+  memcpy(buffer_, &header, sizeof(SlotHeader));
+  memcpy(buffer_ + sizeof(SlotHeader), data.data(), data.size());
+
+  const size_t offset = entry.offset + target * (sizeof(SlotHeader) + entry.capacity);
+  if (!storage_.write(offset, { buffer_, sizeof(SlotHeader) + data.size() }))
+  {
+    if (!moving)
+      slots_[index].scanned = false;
+    return false;
+  }
+
+  // Point the record at its new slots, the old ones stay current if this write is torn and are
+  // reclaimed by format()
+  if (moving)
+  {
+    const Directory previous = directory_;
+    if (index < 0)
+    {
+      index = directory_.count++;
+    }
+    directory_.entries[index] = entry;
+    if (!writeDirectory())
+    {
+      directory_ = previous;
+      return false;
+    }
+  }
+
+  slots_[index] = { true, true, target, header.sequence };
+  return true;
+}
+
+uint32_t ParameterStore::checksum(const SlotHeader& header, const uint8_t* payload)
+{
+  return crc32(payload, header.length, crc32(&header, offsetof(SlotHeader, crc)));
+}
+
+bool ParameterStore::isValid(const Directory& directory)
+{
+  bool valid = directory.magic == kMagic && directory.format == kFormat
+               && directory.count <= kMaxRecords
+               && directory.crc == crc32(&directory, offsetof(Directory, crc));
+  for (size_t i = 0; valid && i < directory.count; ++i)
+  {
+    const Entry& entry = directory.entries[i];
+    valid = entry.capacity <= kMaxRecordSize && entry.offset >= kRecordsOffset
+            && entry.offset + 2 * (sizeof(SlotHeader) + entry.capacity) <= Storage::kSize;
+  }
+  return valid;
+}
+
+int ParameterStore::find(uint16_t key) const
+{
+  for (size_t i = 0; i < directory_.count; ++i)
+  {
+    if (directory_.entries[i].key == key)
+      return i;
+  }
+  return -1;
+}
+
+bool ParameterStore::allocate(uint16_t key, size_t length, Entry& entry)
+{
+  const size_t capacity = (length + kAlignment - 1) / kAlignment * kAlignment;
+  size_t end = kRecordsOffset;
+  for (size_t i = 0; i < directory_.count; ++i)
+  {
+    const Entry& entry = directory_.entries[i];
+    end = std::max<size_t>(end, entry.offset + 2 * (sizeof(SlotHeader) + entry.capacity));
+  }
+
+  if (find(key) < 0 && directory_.count == kMaxRecords)
+  {
+    fprintf(stderr, "Parameter store has no free record\n");
+    return false;
+  }
+  if (end + 2 * (sizeof(SlotHeader) + capacity) > Storage::kSize)
+  {
+    fprintf(stderr, "Parameter store is full\n");
+    return false;
+  }
+
+  // The space may hold slots of a record dropped by format(), which must not be read back. The
+  // first slot is overwritten by the save() that follows, only the second one needs clearing.
+  const SlotHeader empty = {};
+  if (!storage_.write(
+        end + sizeof(SlotHeader) + capacity,
+        { reinterpret_cast<const uint8_t*>(&empty), sizeof(SlotHeader) }))
+  {
+    return false;
+  }
+
+  entry = { key, static_cast<uint16_t>(capacity), static_cast<uint32_t>(end) };
+  return true;
+}
+
+bool ParameterStore::writeDirectory()
+{
+  // Overwrite the older copy, the current one stays valid if this write is torn
+  const uint8_t target = 1 - directory_copy_;
+  ++directory_.sequence;
+  directory_.crc = crc32(&directory_, offsetof(Directory, crc));
+  if (!storage_.write(target * sizeof(Directory),
+                      { reinterpret_cast<const uint8_t*>(&directory_), sizeof(Directory) }))
+  {
+    --directory_.sequence;
+    return false;
+  }
+
+  directory_copy_ = target;
+  return true;
+}
+
+bool ParameterStore::scan(size_t index)
+{
+  const Entry& entry = directory_.entries[index];
+  const size_t slot_size = sizeof(SlotHeader) + entry.capacity;
+  if (!storage_.read(entry.offset, { buffer_, 2 * slot_size }))
+  {
+    slots_[index].scanned = false;
+    return false;
+  }
+
+  SlotState state = { true, false, 0, 0 };
+  for (uint8_t slot = 0; slot < 2; ++slot)
+  {
+    SlotHeader header;
+    memcpy(&header, buffer_ + slot * slot_size, sizeof(SlotHeader));
+    const uint8_t* payload = buffer_ + slot * slot_size + sizeof(SlotHeader);
+    const bool valid = header.length <= entry.capacity && header.crc == checksum(header, payload);
+    if (valid && (!state.valid || isNewer(header.sequence, state.sequence)))
+    {
+      state = { true, true, slot, header.sequence };
+    }
+  }
+  slots_[index] = state;
+  return true;
+}
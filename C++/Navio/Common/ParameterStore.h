@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+#include "./Storage.h"
+
+/**
+ * @brief Versioned, CRC-protected records in a Storage, e.g. calibration and tuning parameters.
+ * A record is a blob, usually a trivially copyable struct, saved under a 16-bit key together
+ * with the version of its layout. Every record has two slots written alternately with an
+ * increasing sequence number, so a save cut short by a power loss leaves the previous copy
+ * readable. Saves overwrite their slot in place; the directory of records is written only when a
+ * record is added or outgrows its slots, and it has two copies written alternately the same way.
+ * Nothing is allocated.
+ *
+ * Data is stored in host byte order.
+ */
+class ParameterStore
+{
+public:
+  static constexpr size_t kMaxRecords = 16;
+  static constexpr size_t kMaxRecordSize = 1024;
+
+  explicit ParameterStore(Storage& storage);
+
+  /** Read the newest valid copy of the directory.
+   * A memory holding no directory of this format is left untouched, it may belong to someone else.
+   * @return False if the storage cannot be accessed or holds no parameter store, format() then
+   * creates one
+   */
+  bool open();
+
+  /** Drop every record, or create an empty store.
+   */
+  bool format();
+
+  /** Copy the newest valid copy of a record into data.
+   * data is left untouched on failure.
+   * @param version Layout version the caller expects
+   * @return False if the record is missing, corrupt in both slots, or was saved with another
+   * version or size
+   */
+  bool load(uint16_t key, uint16_t version, std::span<uint8_t> data);
+
+  /** Replace the older slot of a record, adding the record if needed.
+   * @return False on a storage error, or if data is larger than kMaxRecordSize or does not fit
+   */
+  bool save(uint16_t key, uint16_t version, std::span<const uint8_t> data);
+
+  template <typename T>
+  bool load(uint16_t key, uint16_t version, T& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return load(key, version, std::span<uint8_t>(reinterpret_cast<uint8_t*>(&value), sizeof(T)));
+  }
+
+  template <typename T>
+  bool save(uint16_t key, uint16_t version, const T& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return save(
+      key, version, std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(&value), sizeof(T)));
+  }
+
+private:
+  struct Entry
+  {
+    uint16_t key;
+    uint16_t capacity;  // Payload bytes per slot
+    uint32_t offset;    // Of the first slot, the second one follows it
+  };
+
+  struct Directory
+  {
+    uint32_t magic;
+    uint16_t format;
+    uint16_t count;
+    uint32_t sequence;  // The copy with the newest one is current
+    Entry entries[kMaxRecords];
+    uint32_t crc;
+  };
+
+  struct SlotHeader
+  {
+    uint32_t sequence;
+    uint16_t version;
+    uint16_t length;
+    uint32_t crc;  // Of the fields above and the payload
+  };
+
+  /** Which slot of a record holds its newest valid copy, cached after the first access.
+   */
+  struct SlotState
+  {
+    bool scanned;
+    bool valid;
+    uint8_t newest;
+    uint32_t sequence;
+  };
+
+  static constexpr size_t kSlotSize = sizeof(SlotHeader) + kMaxRecordSize;
+  static constexpr size_t kRecordsOffset = 2 * sizeof(Directory);  // After both directory copies
+
+  static uint32_t checksum(const SlotHeader& header, const uint8_t* payload);
+  static bool isValid(const Directory& directory);
+
+  int find(uint16_t key) const;
+
+  /** Reserve slots for a record at the end of the used space, without adding them to the
+   * directory.
+   * @param entry Directory entry to commit once the first slot is written
+   * @return False if the store has no room left
+   */
+  bool allocate(uint16_t key, size_t length, Entry& entry);
+
+  /** Write directory_ with the next sequence number over the older copy.
+   */
+  bool writeDirectory();
+
+  /** Read both slots of a record into buffer_ and update its SlotState.
+   */
+  bool scan(size_t index);
+
+  Storage& storage_;
+  bool open_;
+  Directory directory_;
+  uint8_t directory_copy_;  // Which copy holds directory_
+  SlotState slots_[kMaxRecords];
+  uint8_t buffer_[2 * kSlotSize];
+};
@@ -1,8 +1,30 @@
 #pragma once
 
+#include <cinttypes>
+#include <cstddef>
+
+struct RCFrame
+{
+  static constexpr size_t kMaxChannels = 16;
+
+  uint64_t timestamp;               // Reception time, CLOCK_MONOTONIC_RAW [ns]
+  uint32_t sequence;                // Incremented for every new frame
+  uint8_t channel_count;            // Number of valid entries in channels
+  bool failsafe;                    // No valid signal, channels hold the last received values
+  uint16_t channels[kMaxChannels];  // Pulse widths [us]
+};
+
 class RCInput
 {
 public:
+  virtual ~RCInput() = default;
+
   virtual void initialize() = 0;
   virtual int read(int c) = 0;
+
+  /** Read every channel at once.
+   * @param frame Latest frame, written even if it is not new
+   * @return True if a frame arrived since the previous call
+   */
+  virtual bool readFrame(RCFrame& frame) = 0;
 };
@@ -1,12 +1,67 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <span>
 
 class RCOutput
 {
 public:
-  virtual bool initialize(const size_t& channel) = 0;
-  virtual bool enable(const size_t& channel) = 0;
-  virtual bool setFrequency(const size_t& channel, const size_t& frequency) = 0;
-  virtual bool setDutyCycle(const size_t& channel, const double& period_us) = 0;
+  static constexpr size_t kMaxChannels = 16;
+
+  virtual ~RCOutput() = default;
+
+  virtual bool initialize(size_t channel) = 0;
+  virtual bool enable(size_t channel) = 0;
+  virtual bool setFrequency(size_t channel, size_t frequency) = 0;
+  virtual bool setDutyCycle(size_t channel, double period_us) = 0;
+
+  /** Number of outputs the backend drives, at most kMaxChannels.
+   */
+  virtual size_t getChannelCount() const = 0;
+
+  /** Set the pulse widths of consecutive channels in one call.
+   * Backends override this when they can update several channels at once.
+   * @param first_channel Channel of period_us[0]
+   * @return False if any channel failed
+   */
+  virtual bool setDutyCycles(size_t first_channel, std::span<const double> period_us)
+  {
+    bool ok = true;
+    for (size_t i = 0; i < period_us.size(); ++i)
+    {
+      ok &= setDutyCycle(first_channel + i, period_us[i]);
+    }
+    return ok;
+  }
+
+  /** Stage the pulse widths of channels 0 to period_us.size() - 1.
+   * Nothing reaches the outputs until commit(), so a control loop writes every motor of a tick
+   * together.
+   * @return False if the frame has more channels than getChannelCount()
+   */
+  bool writeFrame(std::span<const double> period_us)
+  {
+    if (period_us.size() > getChannelCount())
+    {
+      return false;
+    }
+
+    std::copy(period_us.begin(), period_us.end(), frame_);
+    frame_size_ = period_us.size();
+    return true;
+  }
+
+  /** Apply the staged frame to all of its channels with the least skew the backend allows.
+   * The frame stays staged, committing again repeats it.
+   * @return False if any channel failed
+   */
+  virtual bool commit()
+  {
+    return setDutyCycles(0, { frame_, frame_size_ });
+  }
+
+protected:
+  double frame_[kMaxChannels];
+  size_t frame_size_ = 0;
 };
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cinttypes>
+
+#include "./RCOutput.h"
+#include "./Util.h"
+
+/**
+ * @brief RC outputs kept in memory, to run a control loop without hardware.
+ * A multi-channel update is applied atomically and counted as one update, so tests can check that
+ * a tick produced exactly one commit with the expected pulse widths.
+ */
+class RCOutput_Sim : public RCOutput
+{
+public:
+  /**
+   * @param channels Number of outputs to simulate, at most kMaxChannels
+   */
+  inline explicit RCOutput_Sim(size_t channels = kMaxChannels);
+
+  inline bool initialize(size_t channel) override;
+  inline bool enable(size_t channel) override;
+  inline bool setFrequency(size_t channel, size_t frequency) override;
+  inline bool setDutyCycle(size_t channel, double period_us) override;
+  inline size_t getChannelCount() const override;
+  inline bool setDutyCycles(size_t first_channel, std::span<const double> period_us) override;
+
+  /** Pulse width currently applied to a channel, 0 until it is first set.
+   */
+  inline double getDutyCycle(size_t channel) const;
+  inline bool isEnabled(size_t channel) const;
+  inline size_t getFrequency(size_t channel) const;
+
+  /** Number of updates applied so far, a multi-channel update counts once.
+   */
+  inline uint32_t getUpdateCount() const;
+
+  /** get_time_ns() of the last update.
+   */
+  inline uint64_t getUpdateTimestamp() const;
+
+private:
+  inline void stampUpdate();
+
+  size_t channels_;
+  double period_us_[kMaxChannels] = {};
+  size_t frequency_[kMaxChannels] = {};
+  bool enabled_[kMaxChannels] = {};
+
+  uint32_t update_count_ = 0;
+  uint64_t update_timestamp_ = 0;
+};
+
+inline RCOutput_Sim::RCOutput_Sim(size_t channels)
+  : channels_(channels < kMaxChannels ? channels : kMaxChannels)
+{
+}
+
+inline bool RCOutput_Sim::initialize(size_t channel)
+{
+  return channel < channels_;
+}
+
+inline bool RCOutput_Sim::enable(size_t channel)
+{
+  if (channel >= channels_)
+  {
+    return false;
+  }
+
+  enabled_[channel] = true;
+  return true;
+}
+
+inline bool RCOutput_Sim::setFrequency(size_t channel, size_t frequency)
+{
+  if (channel >= channels_)
+  {
+    return false;
+  }
+
+  frequency_[channel] = frequency;
+  return true;
+}
+
+inline bool RCOutput_Sim::setDutyCycle(size_t channel, double period_us)
+{
+  if (channel >= channels_)
+  {
+    return false;
+  }
+
+  period_us_[channel] = period_us;
+  stampUpdate();
+  return true;
+}
+
+inline size_t RCOutput_Sim::getChannelCount() const
+{
+  return channels_;
+}
+
+inline bool RCOutput_Sim::setDutyCycles(size_t first_channel, std::span<const double> period_us)
+{
+  if (first_channel + period_us.size() > channels_)
+  {
+    return false;
+  }
+
+  std::copy(period_us.begin(), period_us.end(), period_us_ + first_channel);
+  stampUpdate();
+  return true;
+}
+
+inline double RCOutput_Sim::getDutyCycle(size_t channel) const
+{
+  return channel < channels_ ? period_us_[channel] : 0;
+}
+
+inline bool RCOutput_Sim::isEnabled(size_t channel) const
+{
+  return channel < channels_ && enabled_[channel];
+}
+
+inline size_t RCOutput_Sim::getFrequency(size_t channel) const
+{
+  return channel < channels_ ? frequency_[channel] : 0;
+}
+
+inline uint32_t RCOutput_Sim::getUpdateCount() const
+{
+  return update_count_;
+}
+
+inline uint64_t RCOutput_Sim::getUpdateTimestamp() const
+{
+  return update_timestamp_;
+}
+
+inline void RCOutput_Sim::stampUpdate()
+{
+  ++update_count_;
+  update_timestamp_ = get_time_ns();
+}
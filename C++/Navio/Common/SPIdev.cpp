@@ -3,6 +3,7 @@
 #include <fcntl.h>
 
 #include "./SPIdev.h"
+#include "./Util.h"
 
 using namespace std;
 
@@ -12,6 +13,8 @@ SPIdev::SPIdev(const char* spidev, uint32_t speed_hz, u_char bits_per_word, u_sh
   spi_transfer_.speed_hz = speed_hz;
   spi_transfer_.bits_per_word = bits_per_word;
   spi_transfer_.delay_usecs = delay_usecs;
+  batch_size_ = 0;
+  transfer_start_ = transfer_end_ = 0;
 
   spi_fd_ = open(spidev, O_RDWR);
   if (spi_fd_ < 0)
@@ -30,5 +33,49 @@ bool SPIdev::transfer(u_char* tx, u_char* rx, uint32_t length)
   spi_transfer_.tx_buf = (u_long)tx;
   spi_transfer_.rx_buf = (u_long)rx;
   spi_transfer_.len = length;
-  return ioctl(spi_fd_, SPI_IOC_MESSAGE(1), &spi_transfer_) >= 0;
+
+  transfer_start_ = get_time_ns();
+  const bool ok = ioctl(spi_fd_, SPI_IOC_MESSAGE(1), &spi_transfer_) >= 0;
+  transfer_end_ = get_time_ns();
+  return ok;
+}
+
+bool SPIdev::queue(u_char* tx, u_char* rx, uint32_t length, bool cs_change)
+{
+  if (batch_size_ >= kMaxBatchSize)
+  {
+    return false;
+  }
+
+  auto& segment = batch_[batch_size_++];
+  segment = spi_transfer_;
+  segment.tx_buf = (u_long)tx;
+  segment.rx_buf = (u_long)rx;
+  segment.len = length;
+  segment.cs_change = cs_change;
+  return true;
+}
+
+bool SPIdev::submit()
+{
+  if (batch_size_ == 0)
+  {
+    return true;
+  }
+
+  // cs_change on the last segment would leave the chip selected after the message
+  batch_[batch_size_ - 1].cs_change = 0;
+
+  const auto size = batch_size_;
+  batch_size_ = 0;
+
+  transfer_start_ = get_time_ns();
+  const bool ok = ioctl(spi_fd_, SPI_IOC_MESSAGE(size), batch_) >= 0;
+  transfer_end_ = get_time_ns();
+  return ok;
+}
+
+uint64_t SPIdev::getTimestamp(bool midpoint) const
+{
+  return midpoint ? transfer_start_ + (transfer_end_ - transfer_start_) / 2 : transfer_end_;
 }
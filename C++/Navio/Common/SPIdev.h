@@ -9,6 +9,8 @@
 
 class SPIdev
 {
+  static constexpr size_t kMaxBatchSize = 64;  // A full LSM9DS1 FIFO, two segments per slot
+
 public:
   explicit SPIdev(
     const char* spidev,
@@ -19,7 +21,31 @@ public:
 
   bool transfer(u_char* tx, u_char* rx, uint32_t length);
 
+  /** Queue a segment for the next submit().
+   * Buffers must stay valid until submit() returns. rx may be nullptr to discard the response.
+   * @param cs_change Deselect the chip between this segment and the next one
+   * @return False if the batch is full
+   */
+  bool queue(u_char* tx, u_char* rx, uint32_t length, bool cs_change = true);
+
+  /** Issue every queued segment in a single SPI_IOC_MESSAGE(N) ioctl and clear the batch.
+   * @return Status of the transfer (true = success)
+   */
+  bool submit();
+
+  /** Time of the last transfer() or submit().
+   * @param midpoint Correct for transfer latency by returning the middle of the ioctl instead of
+   * its completion
+   * @return CLOCK_MONOTONIC_RAW [ns]
+   */
+  uint64_t getTimestamp(bool midpoint = true) const;
+
 private:
   spi_ioc_transfer spi_transfer_;
+  spi_ioc_transfer batch_[kMaxBatchSize];
+  size_t batch_size_;
   int spi_fd_;
+
+  uint64_t transfer_start_;
+  uint64_t transfer_end_;
 };
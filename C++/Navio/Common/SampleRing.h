@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cinttypes>
+#include <type_traits>
+
+/**
+ * @brief Lock-free single-producer/multi-consumer ring of samples.
+ * Every slot is guarded by its own sequence counter (seqlock), so the producer never waits for
+ * consumers and a consumer never observes a half-written sample. Consumers that fall more than N
+ * samples behind lose the oldest ones.
+ */
+template <typename T, size_t N>
+class SampleRing
+{
+  static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of two.");
+  static_assert(std::is_trivially_copyable_v<T>, "T is copied without synchronization.");
+
+  static constexpr size_t kCacheLineSize = 64;
+
+public:
+  explicit SampleRing() : head_(0)
+  {
+    for (auto& slot : slots_)
+      slot.seq.store(0, std::memory_order_relaxed);
+  }
+
+  /** Append a sample, overwriting the oldest one. Only one thread may publish.
+   */
+  void publish(const T& sample)
+  {
+    const uint64_t index = head_.load(std::memory_order_relaxed);
+    auto& slot = slots_[index & (N - 1)];
+
+    slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.data = sample;
+    slot.seq.store(2 * index + 2, std::memory_order_release);
+
+    head_.store(index + 1, std::memory_order_release);
+  }
+
+  /** Copy the most recent sample.
+   * @return False if nothing has been published yet
+   */
+  bool latest(T& sample) const
+  {
+    while (true)
+    {
+      const uint64_t head = head_.load(std::memory_order_acquire);
+      if (head == 0)
+        return false;
+      if (read(head - 1, sample))
+        return true;
+    }
+  }
+
+  /** Copy the sample at cursor and advance the cursor.
+   * A cursor the producer has lapped skips forward to the oldest sample still available.
+   * @param cursor Index of the next sample to read, start from 0 or getHead()
+   * @return False if there is no new sample
+   */
+  bool next(uint64_t& cursor, T& sample) const
+  {
+    while (true)
+    {
+      const uint64_t head = head_.load(std::memory_order_acquire);
+      if (cursor >= head)
+        return false;
+      if (head - cursor > N)
+        cursor = head - N;
+      if (read(cursor, sample))
+      {
+        ++cursor;
+        return true;
+      }
+    }
+  }
+
+  /** Number of samples published so far.
+   */
+  uint64_t getHead() const
+  {
+    return head_.load(std::memory_order_acquire);
+  }
+
+private:
+  struct alignas(kCacheLineSize) Slot
+  {
+    std::atomic<uint64_t> seq;  // 2 * index + 1 while writing, 2 * index + 2 once complete
+    T data;
+  };
+
+  bool read(uint64_t index, T& sample) const
+  {
+    const auto& slot = slots_[index & (N - 1)];
+    const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq != 2 * index + 2)
+      return false;
+
+    sample = slot.data;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.seq.load(std::memory_order_relaxed) == seq;
+  }
+
+  alignas(kCacheLineSize) std::atomic<uint64_t> head_;
+  Slot slots_[N];
+};
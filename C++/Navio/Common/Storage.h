@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <span>
+
+/**
+ * @brief Byte-addressable non-volatile memory: FRAM on Navio+, a file on Navio2.
+ * Both backends have the same size so that data laid out for one fits the other.
+ */
+class Storage
+{
+public:
+  static constexpr size_t kSize = 32768;
+
+  virtual ~Storage() = default;
+
+  /** @return False if the memory cannot be accessed
+   */
+  virtual bool initialize() = 0;
+
+  /** Read data.size() bytes from offset.
+   * @return False on a transfer error or past the end of the memory
+   */
+  virtual bool read(size_t offset, std::span<uint8_t> data) = 0;
+
+  /** Write data.size() bytes at offset. The bytes are durable when this returns.
+   * @return False on a transfer error or past the end of the memory
+   */
+  virtual bool write(size_t offset, std::span<const uint8_t> data) = 0;
+};
@@ -5,6 +5,7 @@
 
 #include "Ublox.h"
 #include "Util.h"
+#include "ubx_decoder.hpp"
 
 #define GPS_DEVICE "/dev/spidev0.0"
 
@@ -41,7 +42,7 @@ int UBXScanner::update(const uint8_t& data)
       if (data == 0x62)
         state_ = Class;
       else if (data == 0xb5)
-        state_ = Sync1;
+        position_ = 1;  // This byte may be the actual start of the message
       else
         reset();
       break;
@@ -61,7 +62,10 @@ int UBXScanner::update(const uint8_t& data)
 
     case Length2:
       payload_length_ += data << 8;
-      state_ = Payload;
+      if (payload_length_ + kPayloadOffset + kChecksumLength > kUbxBufferLength)
+        reset();
+      else
+        state_ = payload_length_ > 0 ? Payload : CK_A;
       break;
 
     case Payload:
@@ -90,6 +94,38 @@ int UBXScanner::update(const uint8_t& data)
   return state_;
 }
 
+size_t UBXScanner::update(std::span<const uint8_t> data)
+{
+  size_t i = 0;
+
+  while (i < data.size() && state_ != Done)
+  {
+    if (state_ == Sync1)
+    {
+      const auto sync = static_cast<const uint8_t*>(memchr(&data[i], 0xb5, data.size() - i));
+      if (sync == nullptr)
+        return data.size();
+      i = sync - data.data();
+    }
+    else if (state_ == Payload)
+    {
+      const size_t remaining = payload_length_ + kPayloadOffset - position_;
+      const size_t count = min(remaining, data.size() - i);
+      memcpy(message_ + position_, &data[i], count);
+      position_ += count;
+      i += count;
+
+      if (position_ == payload_length_ + kPayloadOffset)
+        state_ = CK_A;
+      continue;
+    }
+
+    update(data[i++]);
+  }
+
+  return i;
+}
+
 UBXParser::UBXParser(UBXScanner* ubxsc) : scanner_(ubxsc), message_(ubxsc->getMessage())
 {
 }
@@ -108,15 +144,12 @@ uint16_t UBXParser::calcId()
     return 0;
 
   // Count the checksum
-  uint8_t CK_A = 0, CK_B = 0;
-  for (uint32_t i = 2; i + 2 < length; ++i)  // 符号なしの引き算はオーバーフローのリスクがある
-  {
-    CK_A += *(s + i);
-    CK_B += CK_A;
-  }
-  if (CK_A != *(s + length - 2))
+  if (length < kPayloadOffset + kChecksumLength)
+    return 0;
+  const auto ck = checksum({ s + kPreambleOffset, length - kPreambleOffset - kChecksumLength });
+  if ((ck & 0xFF) != *(s + length - 2))
     return 0;
-  if (CK_B != *(s + length - 1))
+  if ((ck >> 8) != *(s + length - 1))
     return 0;
 
   // If we got everything right, then it's time to decide, what type of message this is
@@ -124,8 +157,28 @@ uint16_t UBXParser::calcId()
   return latest_id_ = (*(s + 2)) << 8 | (*(s + 3));
 }
 
+uint16_t UBXParser::checksum(span<const uint8_t> data)
+{
+  // Unsigned wrap-around keeps both sums exact modulo 256
+  const uint32_t n = data.size();
+  uint32_t CK_A = 0, CK_B = 0;
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    CK_A += data[i];
+    CK_B += (n - i) * data[i];
+  }
+  return (CK_A & 0xFF) | (CK_B & 0xFF) << 8;
+}
+
 Ublox::Ublox()
-  : spi_dev_(GPS_DEVICE, kSpiSpeedHz), scanner_(new UBXScanner()), parser_(new UBXParser(scanner_))
+  : spi_dev_(GPS_DEVICE, kSpiSpeedHz),
+    scanner_(new UBXScanner()),
+    parser_(new UBXParser(scanner_)),
+    message_timestamp_(0),
+    tx_chunk_{},
+    rx_position_(0),
+    rx_length_(0),
+    handler_index_{}
 {
   if (!enableMsg(ACK_NAK, true) || !enableMsg(ACK_ACK, true))
   {
@@ -134,7 +187,14 @@ Ublox::Ublox()
 }
 
 Ublox::Ublox(UBXScanner* scan, UBXParser* pars)
-  : spi_dev_(GPS_DEVICE, kSpiSpeedHz), scanner_(scan), parser_(pars)
+  : spi_dev_(GPS_DEVICE, kSpiSpeedHz),
+    scanner_(scan),
+    parser_(pars),
+    message_timestamp_(0),
+    tx_chunk_{},
+    rx_position_(0),
+    rx_length_(0),
+    handler_index_{}
 {
   if (!enableMsg(ACK_NAK, true) || !enableMsg(ACK_ACK, true))
   {
@@ -230,221 +290,257 @@ bool Ublox::configureGnss_GLONASS(bool enable, uint8_t res_track_ch, uint8_t max
 
 uint16_t Ublox::update()
 {
-  int status = -1;
-  uint8_t to_gps_data = 0, from_gps_data = 0;
+  uint16_t id;
+  while (!scanChunk(id))
+  {
+    receiveChunk();
+  }
+  return id;
+}
 
-  while (status != UBXScanner::Done)
+int Ublox::poll()
+{
+  // Bytes left over from update() first
+  int dispatched = dispatchChunk();
+
+  for (uint32_t chunks = 0; chunks < kMaxPollChunks && receiveChunk(); ++chunks)
   {
-    // From now on, we will send zeroes to the receiver, which it will ignore
-    // However, we are simultaneously getting useful information from it
-    spi_dev_.transfer(&to_gps_data, &from_gps_data, 1);
+    dispatched += dispatchChunk();
 
-    // Scanner checks the message structure with every byte received
-    status = scanner_->update(from_gps_data);
+    // The receiver pads its output with 0xFF once it has nothing more to send
+    if (scanner_->isIdle() && rx_chunk_[kSpiChunkSize - 1] == 0xFF)
+      break;
   }
 
-  scanner_->reset();
-  return parser_->calcId();
+  return dispatched;
 }
 
-void Ublox::decode(NavPosllhPayload& data) const
+void Ublox::subscribe(function<void(const NavPosllhPayload&)> callback)
 {
-  if (parser_->getLatestMsg() != Ublox::NAV_POSLLH)
-  {
-    throw runtime_error("Message type mismatch.");
-  }
+  addHandler(move(callback));
+}
 
-  const auto msg = parser_->getMessage();
-  const auto pos = parser_->getPosition() - parser_->getLength();
-  const auto s = msg + pos;
+void Ublox::subscribe(function<void(const NavStatusPayload&)> callback)
+{
+  addHandler(move(callback));
+}
 
-  data.lon = int((*(s + 13) << 24) | (*(s + 12) << 16) | (*(s + 11) << 8) | (*(s + 10))) * 1e-7;
-  data.lat = int((*(s + 17) << 24) | (*(s + 16) << 16) | (*(s + 15) << 8) | (*(s + 14))) * 1e-7;
-  data.hMSL = int((*(s + 25) << 24) | (*(s + 24) << 16) | (*(s + 23) << 8) | (*(s + 22))) * 1e-3;
+void Ublox::subscribe(function<void(const NavDopPayload&)> callback)
+{
+  addHandler(move(callback));
 }
 
-void Ublox::decode(NavStatusPayload& data) const
+void Ublox::subscribe(function<void(const NavPvtPayload&)> callback)
 {
-  if (parser_->getLatestMsg() != Ublox::NAV_STATUS)
-  {
-    throw runtime_error("Message type mismatch.");
-  }
+  addHandler(move(callback));
+}
+
+void Ublox::subscribe(function<void(const NavVelnedPayload&)> callback)
+{
+  addHandler(move(callback));
+}
 
-  const auto msg = parser_->getMessage();
-  const auto pos = parser_->getPosition() - parser_->getLength();
-  const auto s = msg + pos;
+void Ublox::subscribe(function<void(const NavTimegpsPayload&)> callback)
+{
+  addHandler(move(callback));
+}
 
-  data.gpsFix = uint8_t(*(s + 10));
+void Ublox::subscribe(function<void(const NavTimeutcPayload&)> callback)
+{
+  addHandler(move(callback));
+}
 
-  const auto flags = uint8_t(*(s + 11));
-  data.gpsFixOk = (flags >> 0) & 1;
+void Ublox::subscribe(function<void(const NavCovPayload&)> callback)
+{
+  addHandler(move(callback));
 }
 
-void Ublox::decode(NavDopPayload& data) const
+void Ublox::subscribe(function<void(const MonHwPayload&)> callback)
 {
-  throw;  // TODO
+  addHandler(move(callback));
 }
 
-void Ublox::decode(NavPvtPayload& data) const
+void Ublox::subscribe(function<void(const MonHw2Payload&)> callback)
 {
-  if (parser_->getLatestMsg() != Ublox::NAV_PVT)
+  addHandler(move(callback));
+}
+
+bool Ublox::receiveChunk()
+{
+  // We send zeroes to the receiver, which it will ignore
+  // However, we are simultaneously getting useful information from it
+  rx_position_ = rx_length_ = 0;
+  if (!spi_dev_.transfer(tx_chunk_, rx_chunk_, kSpiChunkSize))
   {
-    throw runtime_error("Message type mismatch.");
+    return false;
   }
 
-  const auto msg = parser_->getMessage();
-  const auto pos = parser_->getPosition() - parser_->getLength();
-  const auto s = msg + pos;
+  rx_length_ = kSpiChunkSize;
+  return true;
+}
 
-  data.year = uint16_t((*(s + 11) << 8) | (*(s + 10)));
-  data.month = uint8_t(*(s + 12));
-  data.day = uint8_t(*(s + 13));
-  data.hour = uint8_t(*(s + 14));
-  data.min = uint8_t(*(s + 15));
-  data.sec = uint8_t(*(s + 16));
+bool Ublox::scanChunk(uint16_t& id)
+{
+  // The previous message stays in the scanner until now, so that it can still be decoded
+  if (scanner_->isDone())
+    scanner_->reset();
 
-  const auto valid = uint8_t(*(s + 17));
-  data.validDate = (valid >> 0) & 1;
-  data.validTime = (valid >> 1) & 1;
-  data.fullyResolved = (valid >> 2) & 1;
-  data.validMag = (valid >> 3) & 1;
+  // The scanner skips the 0xFF padding between messages and checks the message structure
+  rx_position_ += scanner_->update({ rx_chunk_ + rx_position_, rx_length_ - rx_position_ });
+  if (!scanner_->isDone())
+    return false;
 
-  data.tAcc = uint32_t((*(s + 21) << 24) | (*(s + 20) << 16) | (*(s + 19) << 8) | (*(s + 18)));
-  data.nano = int((*(s + 25) << 24) | (*(s + 24) << 16) | (*(s + 23) << 8) | (*(s + 22)));
+  message_timestamp_ = spi_dev_.getTimestamp();
+  id = parser_->calcId();
+  return true;
+}
 
-  data.fixType = uint8_t(*(s + 26));
+int Ublox::dispatchChunk()
+{
+  int dispatched = 0;
 
-  const auto flags = uint8_t(*(s + 27));
-  data.gnssFixOk = (flags >> 0) & 1;
+  uint16_t id;
+  while (scanChunk(id))
+  {
+    const auto index = handler_index_[handlerSlot(id)];
+    if (id == 0 || index == 0)
+      continue;
+
+    const auto& handler = handlers_[index - 1];
+    // A message too short for its payload is dropped, like a corrupted one
+    if (handler.id == id && handler.dispatch && handler.dispatch())
+      ++dispatched;
+  }
 
-  data.lon = int((*(s + 33) << 24) | (*(s + 32) << 16) | (*(s + 31) << 8) | (*(s + 30))) * 1e-7;
-  data.lat = int((*(s + 37) << 24) | (*(s + 36) << 16) | (*(s + 35) << 8) | (*(s + 34))) * 1e-7;
-  data.hMSL = int((*(s + 45) << 24) | (*(s + 44) << 16) | (*(s + 43) << 8) | (*(s + 42))) * 1e-3;
-  data.velN = int((*(s + 57) << 24) | (*(s + 56) << 16) | (*(s + 55) << 8) | (*(s + 54))) * 1e-3;
-  data.velE = int((*(s + 61) << 24) | (*(s + 60) << 16) | (*(s + 59) << 8) | (*(s + 58))) * 1e-3;
-  data.velD = int((*(s + 65) << 24) | (*(s + 64) << 16) | (*(s + 63) << 8) | (*(s + 62))) * 1e-3;
+  return dispatched;
 }
 
-void Ublox::decode(NavVelnedPayload& data) const
+template <typename Payload>
+void Ublox::addHandler(function<void(const Payload&)> callback)
 {
-  if (parser_->getLatestMsg() != Ublox::NAV_VELNED)
+  const uint16_t id = ubx::UbxLayout<Payload>::kId;
+
+  Handler handler = { id, nullptr };
+  if (callback)
   {
-    throw runtime_error("Message type mismatch.");
+    handler.dispatch = [this, callback = move(callback)]() {
+      Payload data;
+      if (!decodePayload(data))
+        return false;
+      callback(data);
+      return true;
+    };
   }
 
-  const auto msg = parser_->getMessage();
-  const auto pos = parser_->getPosition() - parser_->getLength();
-  const auto s = msg + pos;
-
-  data.velN = int((*(s + 13) << 24) | (*(s + 12) << 16) | (*(s + 11) << 8) | (*(s + 10))) * 1e-2;
-  data.velE = int((*(s + 17) << 24) | (*(s + 16) << 16) | (*(s + 15) << 8) | (*(s + 14))) * 1e-2;
-  data.velD = int((*(s + 21) << 24) | (*(s + 20) << 16) | (*(s + 19) << 8) | (*(s + 18))) * 1e-2;
+  auto& index = handler_index_[handlerSlot(id)];
+  if (index == 0)
+  {
+    handlers_.push_back(move(handler));
+    index = handlers_.size();
+  }
+  else
+  {
+    handlers_[index - 1] = move(handler);
+  }
 }
 
-void Ublox::decode(NavTimegpsPayload& data) const
+uint64_t Ublox::getTimestamp() const
 {
-  throw;  // TODO
+  return message_timestamp_;
 }
 
-void Ublox::decode(NavTimeutcPayload& data) const
+template <typename Payload>
+bool Ublox::decodePayload(Payload& data) const
 {
-  if (parser_->getLatestMsg() != Ublox::NAV_TIMEUTC)
+  using Layout = ubx::UbxLayout<Payload>;
+
+  const auto length = parser_->getLength();
+  if (parser_->getLatestMsg() != Layout::kId
+      || length < kPayloadOffset + Layout::Fields::kLength + kChecksumLength)
   {
-    throw runtime_error("Message type mismatch.");
+    return false;
   }
 
-  const auto msg = parser_->getMessage();
-  const auto pos = parser_->getPosition() - parser_->getLength();
-  const auto s = msg + pos;
+  const auto s = parser_->getMessage() + parser_->getPosition() - length;
 
-  data.tAcc = uint32_t((*(s + 13) << 24) | (*(s + 12) << 16) | (*(s + 11) << 8) | (*(s + 10)));
-  data.nano = int((*(s + 17) << 24) | (*(s + 16) << 16) | (*(s + 15) << 8) | (*(s + 14)));
-  data.year = uint16_t((*(s + 19) << 8) | (*(s + 18)));
-  data.month = uint8_t(*(s + 20));
-  data.day = uint8_t(*(s + 21));
-  data.hour = uint8_t(*(s + 22));
-  data.min = uint8_t(*(s + 23));
-  data.sec = uint8_t(*(s + 24));
+  if constexpr (requires { data.timestamp; })
+    data.timestamp = message_timestamp_;
 
-  const auto valid = uint8_t(*(s + 25));
-  data.validUTC = (valid >> 2) & 1;
+  Layout::Fields::decode(s + kPayloadOffset, data);
+  return true;
 }
 
-void Ublox::decode(NavCovPayload& data) const
+template <typename Payload>
+void Ublox::decodeOrThrow(Payload& data) const
 {
-  if (parser_->getLatestMsg() != Ublox::NAV_COV)
+  if (parser_->getLatestMsg() != ubx::UbxLayout<Payload>::kId)
   {
     throw runtime_error("Message type mismatch.");
   }
+  if (!decodePayload(data))
+  {
+    throw runtime_error("Message too short.");
+  }
+}
 
-  const auto msg = parser_->getMessage();
-  const auto pos = parser_->getPosition() - parser_->getLength();
-  const auto s = msg + pos;
-
-  data.posCovNN =
-    decodeBinary32((*(s + 25) << 24) | (*(s + 24) << 16) | (*(s + 23) << 8) | (*(s + 22)));
-  data.posCovNE =
-    decodeBinary32((*(s + 29) << 24) | (*(s + 28) << 16) | (*(s + 27) << 8) | (*(s + 26)));
-  data.posCovND =
-    decodeBinary32((*(s + 33) << 24) | (*(s + 32) << 16) | (*(s + 31) << 8) | (*(s + 30)));
-  data.posCovEE =
-    decodeBinary32((*(s + 37) << 24) | (*(s + 36) << 16) | (*(s + 35) << 8) | (*(s + 34)));
-  data.posCovED =
-    decodeBinary32((*(s + 41) << 24) | (*(s + 40) << 16) | (*(s + 39) << 8) | (*(s + 38)));
-  data.posCovDD =
-    decodeBinary32((*(s + 45) << 24) | (*(s + 44) << 16) | (*(s + 43) << 8) | (*(s + 42)));
-  data.velCovNN =
-    decodeBinary32((*(s + 49) << 24) | (*(s + 48) << 16) | (*(s + 47) << 8) | (*(s + 46)));
-  data.velCovNE =
-    decodeBinary32((*(s + 53) << 24) | (*(s + 52) << 16) | (*(s + 51) << 8) | (*(s + 50)));
-  data.velCovND =
-    decodeBinary32((*(s + 57) << 24) | (*(s + 56) << 16) | (*(s + 55) << 8) | (*(s + 54)));
-  data.velCovEE =
-    decodeBinary32((*(s + 61) << 24) | (*(s + 60) << 16) | (*(s + 59) << 8) | (*(s + 58)));
-  data.velCovED =
-    decodeBinary32((*(s + 65) << 24) | (*(s + 64) << 16) | (*(s + 63) << 8) | (*(s + 62)));
-  data.velCovDD =
-    decodeBinary32((*(s + 69) << 24) | (*(s + 68) << 16) | (*(s + 67) << 8) | (*(s + 66)));
+void Ublox::decode(NavPosllhPayload& data) const
+{
+  decodeOrThrow(data);
 }
 
-void Ublox::decode(AckNakPayload& data) const
+void Ublox::decode(NavStatusPayload& data) const
 {
-  if (parser_->getLatestMsg() != Ublox::ACK_NAK)
-  {
-    throw runtime_error("Message type mismatch.");
-  }
+  decodeOrThrow(data);
+}
 
-  const auto msg = parser_->getMessage();
-  const auto pos = parser_->getPosition() - parser_->getLength();
-  const auto s = msg + pos;
+void Ublox::decode(NavDopPayload& data) const
+{
+  decodeOrThrow(data);
+}
 
-  data.clsID = uint8_t(*(s + 6));
-  data.msgID = uint8_t(*(s + 7));
+void Ublox::decode(NavPvtPayload& data) const
+{
+  decodeOrThrow(data);
 }
 
-void Ublox::decode(AckAckPayload& data) const
+void Ublox::decode(NavVelnedPayload& data) const
 {
-  if (parser_->getLatestMsg() != Ublox::ACK_ACK)
-  {
-    throw runtime_error("Message type mismatch.");
-  }
+  decodeOrThrow(data);
+}
 
-  const auto msg = parser_->getMessage();
-  const auto pos = parser_->getPosition() - parser_->getLength();
-  const auto s = msg + pos;
+void Ublox::decode(NavTimegpsPayload& data) const
+{
+  decodeOrThrow(data);
+}
 
-  data.clsID = uint8_t(*(s + 6));
-  data.msgID = uint8_t(*(s + 7));
+void Ublox::decode(NavTimeutcPayload& data) const
+{
+  decodeOrThrow(data);
+}
+
+void Ublox::decode(NavCovPayload& data) const
+{
+  decodeOrThrow(data);
+}
+
+void Ublox::decode(AckNakPayload& data) const
+{
+  decodeOrThrow(data);
+}
+
+void Ublox::decode(AckAckPayload& data) const
+{
+  decodeOrThrow(data);
 }
 
 void Ublox::decode(MonHwPayload& data) const
 {
-  throw;  // TODO
+  decodeOrThrow(data);
 }
 
 void Ublox::decode(MonHw2Payload& data) const
 {
-  throw;  // TODO
+  decodeOrThrow(data);
 }
 
 bool Ublox::sendMessage(uint8_t msg_class, uint8_t msg_id, void* msg, uint16_t size)
@@ -475,14 +571,11 @@ int Ublox::spliceMemory(uint8_t* dest, const void* const src, size_t size, int d
 
 Ublox::CheckSum Ublox::calculateCheckSum(uint8_t* message, size_t size) const
 {
-  CheckSum checksum;
-  checksum.CK_A = checksum.CK_B = 0;
+  const auto ck = UBXParser::checksum({ message + kPreambleOffset, size - kPreambleOffset });
 
-  for (size_t i = kPreambleOffset; i < size; ++i)
-  {
-    checksum.CK_A += message[i];
-    checksum.CK_B += checksum.CK_A;
-  }
+  CheckSum checksum;
+  checksum.CK_A = ck & 0xFF;
+  checksum.CK_B = ck >> 8;
   return checksum;
 }
 
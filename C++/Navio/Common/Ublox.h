@@ -1,6 +1,10 @@
 #pragma once
 
+#include <array>
+#include <functional>
+#include <span>
 #include <string>
+#include <vector>
 
 #include "./SPIdev.h"
 #include "./ubx_payload.hpp"
@@ -9,7 +13,11 @@
 
 static constexpr uint32_t kUbxBufferLength = 1024;
 static constexpr uint32_t kPreambleOffset = 2;
+static constexpr uint32_t kPayloadOffset = 6;  // Preamble, class, ID and length
+static constexpr uint32_t kChecksumLength = 2;
 static constexpr uint32_t kSpiSpeedHz = 5500000;  // Maximum frequency is 5.5MHz
+static constexpr uint32_t kSpiChunkSize = 128;    // Bytes read from the receiver per transfer
+static constexpr uint32_t kMaxPollChunks = 32;    // Bounds the time spent in a single poll()
 static constexpr uint32_t kConfigureMessageSize = 11;
 static constexpr uint32_t kMinMaxTrkChForMajorGnss = 4;
 static constexpr uint32_t kWaitForGnssAck = 1000000;  // [us]
@@ -36,10 +44,19 @@ public:
   inline uint8_t* getMessage();
   inline const uint32_t& getMessageLength() const;
   inline const uint32_t& getPosition() const;
+  inline bool isIdle() const;
+  inline bool isDone() const;
 
   void reset();
   int update(const uint8_t& data);
 
+  /** Consume bytes until a message completes or the data runs out.
+   * Skips to the next preamble with memchr() and copies the payload in bulk, so a whole chunk
+   * is processed per call instead of one byte.
+   * @return Number of bytes consumed
+   */
+  size_t update(std::span<const uint8_t> data);
+
 private:
   uint8_t message_[kUbxBufferLength];  // Buffer for UBX message
   uint32_t message_length_;            // Length of the received message
@@ -55,6 +72,13 @@ public:
 
   uint16_t calcId();
 
+  /** 8-bit Fletcher checksum (p.171, 32.4 UBX Checksum) of a whole span.
+   * Uses the closed form CK_A = sum(b_i), CK_B = sum((n - i) * b_i) (mod 256), which the compiler
+   * vectorizes, instead of the serial running sums.
+   * @return CK_A in the low byte, CK_B in the high byte
+   */
+  static uint16_t checksum(std::span<const uint8_t> data);
+
   inline uint8_t* getMessage() const;
   inline const uint32_t& getLength() const;
   inline const uint32_t& getPosition() const;
@@ -186,8 +210,34 @@ public:
   bool configureGnss_QZSS(bool enable, uint8_t res_track_ch = 0, uint8_t max_track_ch = 3);
   bool configureGnss_GLONASS(bool enable, uint8_t res_track_ch = 8, uint8_t max_track_ch = 14);
 
+  /* Block until the next message arrives and return its class + ID, or 0 if it is corrupted. */
   uint16_t update();
 
+  /** Process whatever the receiver has buffered without waiting for more, and pass every complete
+   * message to its subscriber. Messages without a subscriber, or too short for their payload, are
+   * dropped; poll() does not throw.
+   * @return Number of messages dispatched to subscribers
+   */
+  int poll();
+
+  /** Register the callback poll() calls with every message of the payload's type.
+   * Replaces the previous callback for that message, an empty callback unsubscribes. The message
+   * still has to be enabled with enableMsg().
+   */
+  void subscribe(std::function<void(const NavPosllhPayload&)> callback);
+  void subscribe(std::function<void(const NavStatusPayload&)> callback);
+  void subscribe(std::function<void(const NavDopPayload&)> callback);
+  void subscribe(std::function<void(const NavPvtPayload&)> callback);
+  void subscribe(std::function<void(const NavVelnedPayload&)> callback);
+  void subscribe(std::function<void(const NavTimegpsPayload&)> callback);
+  void subscribe(std::function<void(const NavTimeutcPayload&)> callback);
+  void subscribe(std::function<void(const NavCovPayload&)> callback);
+  void subscribe(std::function<void(const MonHwPayload&)> callback);
+  void subscribe(std::function<void(const MonHw2Payload&)> callback);
+
+  /* Reception time of the last message received by update() or poll(), CLOCK_MONOTONIC_RAW [ns]. */
+  uint64_t getTimestamp() const;
+
   void decode(NavPosllhPayload& data) const;
   void decode(NavStatusPayload& data) const;
   void decode(NavDopPayload& data) const;
@@ -276,9 +326,55 @@ private:
   };
   /* ==============================*/
 
+  struct Handler
+  {
+    uint16_t id;  // Class + ID, slots are shared by classes with the same low nibble
+    std::function<bool()> dispatch;  // False if the message does not decode
+  };
+
+  static constexpr size_t kHandlerSlots = 1 << 12;  // Low nibble of the class and the ID
+
+  static constexpr size_t handlerSlot(uint16_t id)
+  {
+    return ((id >> 8) & 0x0F) << 8 | (id & 0xFF);
+  }
+
   SPIdev spi_dev_;
   UBXScanner* scanner_;
   UBXParser* parser_;
+  uint64_t message_timestamp_;
+
+  uint8_t tx_chunk_[kSpiChunkSize];  // Zeroes, which the receiver ignores
+  uint8_t rx_chunk_[kSpiChunkSize];  // Bytes received but not yet scanned
+  uint32_t rx_position_;
+  uint32_t rx_length_;
+
+  std::array<uint8_t, kHandlerSlots> handler_index_;  // 1-based index into handlers_, 0 if none
+  std::vector<Handler> handlers_;
+
+  /* Read the next chunk of the receiver's output stream into rx_chunk_. */
+  bool receiveChunk();
+
+  /** Scan the buffered bytes until a message completes.
+   * @param id Class + ID of the completed message, 0 if it is corrupted
+   * @return False once the buffer is exhausted
+   */
+  bool scanChunk(uint16_t& id);
+
+  /* Scan the buffered bytes and dispatch every complete message to its subscriber. */
+  int dispatchChunk();
+
+  template <typename Payload>
+  void addHandler(std::function<void(const Payload&)> callback);
+
+  /* Check the latest message against the payload's field table and decode it, false if it does
+   * not match. */
+  template <typename Payload>
+  bool decodePayload(Payload& data) const;
+
+  /* decodePayload() for the public decode(), which throws on a mismatch. */
+  template <typename Payload>
+  void decodeOrThrow(Payload& data) const;
 
   bool sendMessage(uint8_t msg_class, uint8_t msg_id, void* msg, uint16_t size);
   int spliceMemory(uint8_t* dest, const void* const src, size_t size, int dest_offset = 0);
@@ -305,6 +401,16 @@ inline const uint32_t& UBXScanner::getPosition() const
   return position_;
 }
 
+inline bool UBXScanner::isIdle() const
+{
+  return state_ == Sync1;
+}
+
+inline bool UBXScanner::isDone() const
+{
+  return state_ == Done;
+}
+
 inline uint8_t* UBXParser::getMessage() const
 {
   return message_;
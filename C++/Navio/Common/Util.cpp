@@ -1,11 +1,11 @@
 #include <cstdio>
-#include <cmath>
 #include <cinttypes>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <time.h>
 
 #include "./Util.h"
 
@@ -83,10 +83,9 @@ int get_navio_version()
   return version;
 }
 
-float decodeBinary32(uint32_t bin)
+uint64_t get_time_ns()
 {
-  const int sign = bin >> 31 ? -1 : 1;
-  const int exponent = (bin >> 23) & 0xFF;
-  const int mantissa = (exponent == 0) ? (bin & 0x7FFFFF) << 1 : (bin & 0x7FFFFF) | 0x800000;
-  return sign * mantissa * pow(2, exponent - 150);
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
 }
@@ -11,5 +11,5 @@ int read_file(const char* path, const char* fmt, ...);
 bool check_apm();
 int get_navio_version();
 
-/* Decode IEEE 754 single precision floating point number. */
-float decodeBinary32(uint32_t bin);
+/* CLOCK_MONOTONIC_RAW in nanoseconds, unaffected by NTP slewing and wall-clock jumps. */
+uint64_t get_time_ns();
@@ -0,0 +1,486 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+/**
+ * @brief Fixed-size vector, quaternion and matrix types for the estimators.
+ * Everything lives on the stack and is sized at compile time. The arithmetic is constexpr, the
+ * functions built on <cmath> (norm, normalized, fromEuler, integrated, toEuler, symmetricEigen)
+ * are not. Matrices are stored row-major and their kernels iterate the innermost loop over
+ * contiguous columns, so GCC vectorizes them with NEON on the Raspberry Pi and SSE on a
+ * development host.
+ */
+namespace linalg
+{
+struct Vec3
+{
+  float x, y, z;
+
+  constexpr float& operator[](size_t i)
+  {
+    return i == 0 ? x : (i == 1 ? y : z);
+  }
+
+  constexpr float operator[](size_t i) const
+  {
+    return i == 0 ? x : (i == 1 ? y : z);
+  }
+
+  constexpr Vec3 operator-() const
+  {
+    return { -x, -y, -z };
+  }
+
+  constexpr Vec3& operator+=(const Vec3& v)
+  {
+    x += v.x;
+    y += v.y;
+    z += v.z;
+    return *this;
+  }
+
+  constexpr Vec3& operator-=(const Vec3& v)
+  {
+    x -= v.x;
+    y -= v.y;
+    z -= v.z;
+    return *this;
+  }
+
+  constexpr Vec3& operator*=(float s)
+  {
+    x *= s;
+    y *= s;
+    z *= s;
+    return *this;
+  }
+
+  constexpr float dot(const Vec3& v) const
+  {
+    return x * v.x + y * v.y + z * v.z;
+  }
+
+  constexpr Vec3 cross(const Vec3& v) const
+  {
+    return { y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x };
+  }
+
+  constexpr float squaredNorm() const
+  {
+    return dot(*this);
+  }
+
+  float norm() const
+  {
+    return std::sqrt(squaredNorm());
+  }
+
+  /** Unit vector, or zero for the zero vector instead of NaN.
+   */
+  Vec3 normalized() const
+  {
+    const float n2 = squaredNorm();
+    const float s = n2 > 0.f ? 1.f / std::sqrt(n2) : 0.f;
+    return { x * s, y * s, z * s };
+  }
+};
+
+constexpr Vec3 operator+(Vec3 a, const Vec3& b)
+{
+  return a += b;
+}
+
+constexpr Vec3 operator-(Vec3 a, const Vec3& b)
+{
+  return a -= b;
+}
+
+constexpr Vec3 operator*(Vec3 v, float s)
+{
+  return v *= s;
+}
+
+constexpr Vec3 operator*(float s, Vec3 v)
+{
+  return v *= s;
+}
+
+template <size_t R, size_t C>
+struct Mat
+{
+  float m[R][C];
+
+  static constexpr size_t kRows = R;
+  static constexpr size_t kCols = C;
+
+  static constexpr Mat zero()
+  {
+    Mat out{};
+    return out;
+  }
+
+  static constexpr Mat identity()
+  {
+    static_assert(R == C);
+    Mat out{};
+    for (size_t i = 0; i < R; ++i)
+      out.m[i][i] = 1;
+    return out;
+  }
+
+  constexpr float* operator[](size_t row)
+  {
+    return m[row];
+  }
+
+  constexpr const float* operator[](size_t row) const
+  {
+    return m[row];
+  }
+
+  constexpr Mat<C, R> transposed() const
+  {
+    Mat<C, R> out{};
+    for (size_t i = 0; i < R; ++i)
+    {
+      for (size_t j = 0; j < C; ++j)
+        out.m[j][i] = m[i][j];
+    }
+    return out;
+  }
+
+  /** Copy of the BR x BC block starting at (row, col).
+   */
+  template <size_t BR, size_t BC>
+  constexpr Mat<BR, BC> block(size_t row, size_t col) const
+  {
+    Mat<BR, BC> out{};
+    for (size_t i = 0; i < BR; ++i)
+    {
+      for (size_t j = 0; j < BC; ++j)
+        out.m[i][j] = m[row + i][col + j];
+    }
+    return out;
+  }
+
+  template <size_t BR, size_t BC>
+  constexpr void setBlock(size_t row, size_t col, const Mat<BR, BC>& b)
+  {
+    for (size_t i = 0; i < BR; ++i)
+    {
+      for (size_t j = 0; j < BC; ++j)
+        m[row + i][col + j] = b.m[i][j];
+    }
+  }
+
+  constexpr Vec3 row(size_t i) const
+  {
+    static_assert(C == 3);
+    return { m[i][0], m[i][1], m[i][2] };
+  }
+
+  constexpr Mat& operator+=(const Mat& b)
+  {
+    for (size_t i = 0; i < R; ++i)
+    {
+      for (size_t j = 0; j < C; ++j)
+        m[i][j] += b.m[i][j];
+    }
+    return *this;
+  }
+
+  constexpr Mat& operator-=(const Mat& b)
+  {
+    for (size_t i = 0; i < R; ++i)
+    {
+      for (size_t j = 0; j < C; ++j)
+        m[i][j] -= b.m[i][j];
+    }
+    return *this;
+  }
+
+  constexpr Mat& operator*=(float s)
+  {
+    for (auto& row : m)
+    {
+      for (auto& value : row)
+        value *= s;
+    }
+    return *this;
+  }
+
+  /** Average with the transpose, against rounding in covariance updates.
+   */
+  constexpr void symmetrize()
+  {
+    static_assert(R == C);
+    for (size_t i = 0; i < R; ++i)
+    {
+      for (size_t j = i + 1; j < C; ++j)
+        m[i][j] = m[j][i] = 0.5f * (m[i][j] + m[j][i]);
+    }
+  }
+};
+
+template <size_t R, size_t C>
+constexpr Mat<R, C> operator+(Mat<R, C> a, const Mat<R, C>& b)
+{
+  return a += b;
+}
+
+template <size_t R, size_t C>
+constexpr Mat<R, C> operator-(Mat<R, C> a, const Mat<R, C>& b)
+{
+  return a -= b;
+}
+
+template <size_t R, size_t C>
+constexpr Mat<R, C> operator*(Mat<R, C> a, float s)
+{
+  return a *= s;
+}
+
+template <size_t R, size_t N, size_t C>
+constexpr Mat<R, C> operator*(const Mat<R, N>& a, const Mat<N, C>& b)
+{
+  Mat<R, C> out{};
+  for (size_t i = 0; i < R; ++i)
+  {
+    for (size_t k = 0; k < N; ++k)
+    {
+      const float aik = a.m[i][k];
+      for (size_t j = 0; j < C; ++j)
+        out.m[i][j] += aik * b.m[k][j];
+    }
+  }
+  return out;
+}
+
+constexpr Vec3 operator*(const Mat<3, 3>& a, const Vec3& v)
+{
+  return { a.row(0).dot(v), a.row(1).dot(v), a.row(2).dot(v) };
+}
+
+/** a * b^T without forming the transpose.
+ */
+template <size_t R, size_t N, size_t C>
+constexpr Mat<R, C> multiplyTransposed(const Mat<R, N>& a, const Mat<C, N>& b)
+{
+  Mat<R, C> out{};
+  for (size_t i = 0; i < R; ++i)
+  {
+    for (size_t j = 0; j < C; ++j)
+    {
+      float sum = 0;
+      for (size_t k = 0; k < N; ++k)
+        sum += a.m[i][k] * b.m[j][k];
+      out.m[i][j] = sum;
+    }
+  }
+  return out;
+}
+
+/** f * p * f^T for a symmetric p, computing only the upper triangle of the result.
+ */
+template <size_t N>
+constexpr Mat<N, N> sandwich(const Mat<N, N>& f, const Mat<N, N>& p)
+{
+  const Mat<N, N> fp = f * p;
+  Mat<N, N> out{};
+  for (size_t i = 0; i < N; ++i)
+  {
+    for (size_t j = i; j < N; ++j)
+    {
+      float sum = 0;
+      for (size_t k = 0; k < N; ++k)
+        sum += fp.m[i][k] * f.m[j][k];
+      out.m[i][j] = out.m[j][i] = sum;
+    }
+  }
+  return out;
+}
+
+constexpr float determinant(const Mat<3, 3>& a)
+{
+  return a.m[0][0] * (a.m[1][1] * a.m[2][2] - a.m[1][2] * a.m[2][1])
+         + a.m[0][1] * (a.m[1][2] * a.m[2][0] - a.m[1][0] * a.m[2][2])
+         + a.m[0][2] * (a.m[1][0] * a.m[2][1] - a.m[1][1] * a.m[2][0]);
+}
+
+/** Closed-form inverse of a 3x3 matrix.
+ * @return False if the matrix is singular
+ */
+constexpr bool invert(const Mat<3, 3>& a, Mat<3, 3>& out)
+{
+  const float c00 = a.m[1][1] * a.m[2][2] - a.m[1][2] * a.m[2][1];
+  const float c01 = a.m[1][2] * a.m[2][0] - a.m[1][0] * a.m[2][2];
+  const float c02 = a.m[1][0] * a.m[2][1] - a.m[1][1] * a.m[2][0];
+  const float det = a.m[0][0] * c00 + a.m[0][1] * c01 + a.m[0][2] * c02;
+  if (!(det > 0 || det < 0))  // Also rejects NaN
+    return false;
+
+  const float inv = 1 / det;
+  out.m[0][0] = c00 * inv;
+  out.m[1][0] = c01 * inv;
+  out.m[2][0] = c02 * inv;
+  out.m[0][1] = (a.m[0][2] * a.m[2][1] - a.m[0][1] * a.m[2][2]) * inv;
+  out.m[1][1] = (a.m[0][0] * a.m[2][2] - a.m[0][2] * a.m[2][0]) * inv;
+  out.m[2][1] = (a.m[0][1] * a.m[2][0] - a.m[0][0] * a.m[2][1]) * inv;
+  out.m[0][2] = (a.m[0][1] * a.m[1][2] - a.m[0][2] * a.m[1][1]) * inv;
+  out.m[1][2] = (a.m[0][2] * a.m[1][0] - a.m[0][0] * a.m[1][2]) * inv;
+  out.m[2][2] = (a.m[0][0] * a.m[1][1] - a.m[0][1] * a.m[1][0]) * inv;
+  return true;
+}
+
+/** Inverse of a symmetric positive definite 3x3 matrix.
+ * @return False if the determinant is not positive
+ */
+constexpr bool invertPositiveDefinite(const Mat<3, 3>& a, Mat<3, 3>& out)
+{
+  return determinant(a) > 0 && invert(a, out);
+}
+
+/** Eigen decomposition of a symmetric matrix by cyclic Jacobi rotations.
+ * @param values Eigenvalues, unordered
+ * @param vectors Orthonormal eigenvectors as columns, a == vectors * diag(values) * vectors^T
+ */
+inline void symmetricEigen(Mat<3, 3> a, Vec3& values, Mat<3, 3>& vectors)
+{
+  static constexpr size_t kPairs[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+  static constexpr int kMaxSweeps = 16;
+
+  vectors = Mat<3, 3>::identity();
+  for (int sweep = 0; sweep < kMaxSweeps; ++sweep)
+  {
+    const float off_diagonal =
+      a.m[0][1] * a.m[0][1] + a.m[0][2] * a.m[0][2] + a.m[1][2] * a.m[1][2];
+    const float diagonal = a.m[0][0] * a.m[0][0] + a.m[1][1] * a.m[1][1] + a.m[2][2] * a.m[2][2];
+    if (off_diagonal <= 1e-14f * diagonal)
+      break;
+
+    for (const auto& pair : kPairs)
+    {
+      const size_t p = pair[0], q = pair[1];
+      if (a.m[p][q] == 0)
+        continue;
+
+      // Rotation in the (p, q) plane that zeroes a[p][q], applied as a = J^T a J
+      const float theta = (a.m[q][q] - a.m[p][p]) / (2 * a.m[p][q]);
+      const float t = std::copysign(1.f, theta) / (std::fabs(theta) + std::sqrt(theta * theta + 1));
+      const float c = 1 / std::sqrt(t * t + 1), s = t * c;
+      for (size_t k = 0; k < 3; ++k)
+      {
+        const float akp = a.m[k][p], akq = a.m[k][q];
+        a.m[k][p] = c * akp - s * akq;
+        a.m[k][q] = s * akp + c * akq;
+
+        const float vkp = vectors.m[k][p], vkq = vectors.m[k][q];
+        vectors.m[k][p] = c * vkp - s * vkq;
+        vectors.m[k][q] = s * vkp + c * vkq;
+      }
+      for (size_t k = 0; k < 3; ++k)
+      {
+        const float apk = a.m[p][k], aqk = a.m[q][k];
+        a.m[p][k] = c * apk - s * aqk;
+        a.m[q][k] = s * apk + c * aqk;
+      }
+    }
+  }
+  values = { a.m[0][0], a.m[1][1], a.m[2][2] };
+}
+
+/** Cross-product matrix, skew(a) * b == a.cross(b).
+ */
+constexpr Mat<3, 3> skew(const Vec3& v)
+{
+  return { { { 0, -v.z, v.y }, { v.z, 0, -v.x }, { -v.y, v.x, 0 } } };
+}
+
+/**
+ * @brief Hamilton quaternion, w + xi + yj + zk.
+ * Attitudes are unit quaternions rotating body vectors into the reference frame.
+ */
+struct Quat
+{
+  float w, x, y, z;
+
+  static constexpr Quat identity()
+  {
+    return { 1, 0, 0, 0 };
+  }
+
+  /** Roll, pitch and yaw applied in Z-Y-X order [rad].
+   */
+  static Quat fromEuler(float roll, float pitch, float yaw)
+  {
+    const float cr = std::cos(roll / 2), sr = std::sin(roll / 2);
+    const float cp = std::cos(pitch / 2), sp = std::sin(pitch / 2);
+    const float cy = std::cos(yaw / 2), sy = std::sin(yaw / 2);
+    return { cr * cp * cy + sr * sp * sy, sr * cp * cy - cr * sp * sy,
+             cr * sp * cy + sr * cp * sy, cr * cp * sy - sr * sp * cy };
+  }
+
+  constexpr Vec3 vec() const
+  {
+    return { x, y, z };
+  }
+
+  constexpr Quat conjugate() const
+  {
+    return { w, -x, -y, -z };
+  }
+
+  constexpr Quat operator*(const Quat& q) const
+  {
+    return { w * q.w - x * q.x - y * q.y - z * q.z, w * q.x + x * q.w + y * q.z - z * q.y,
+             w * q.y - x * q.z + y * q.w + z * q.x, w * q.z + x * q.y - y * q.x + z * q.w };
+  }
+
+  Quat normalized() const
+  {
+    const float s = 1.f / std::sqrt(w * w + x * x + y * y + z * z);
+    return { w * s, x * s, y * s, z * s };
+  }
+
+  /** Apply a small body-frame rotation, q * [1, theta / 2], and renormalize.
+   * First order in theta, exact enough for one IMU sample or one Kalman correction.
+   */
+  Quat integrated(const Vec3& theta) const
+  {
+    const Vec3 h = theta * 0.5f;
+    return Quat{ w - x * h.x - y * h.y - z * h.z, x + w * h.x + y * h.z - z * h.y,
+                 y + w * h.y - x * h.z + z * h.x, z + w * h.z + x * h.y - y * h.x }
+      .normalized();
+  }
+
+  /** Rotation matrix, body to reference frame.
+   */
+  constexpr Mat<3, 3> toRotation() const
+  {
+    return { { { 1 - 2 * (y * y + z * z), 2 * (x * y - w * z), 2 * (x * z + w * y) },
+               { 2 * (x * y + w * z), 1 - 2 * (x * x + z * z), 2 * (y * z - w * x) },
+               { 2 * (x * z - w * y), 2 * (y * z + w * x), 1 - 2 * (x * x + y * y) } } };
+  }
+
+  /** Rotate a body vector into the reference frame.
+   */
+  constexpr Vec3 rotate(const Vec3& v) const
+  {
+    const Vec3 u = vec();
+    const Vec3 t = u.cross(v) * 2.f;
+    return v + t * w + u.cross(t);
+  }
+
+  /** Z-Y-X Euler angles: roll, pitch and yaw [rad].
+   */
+  Vec3 toEuler() const
+  {
+    const float sin_pitch = 2 * (w * y - z * x);
+    return { std::atan2(2 * (w * x + y * z), 1 - 2 * (x * x + y * y)),
+             std::asin(std::fmax(-1.f, std::fmin(1.f, sin_pitch))),
+             std::atan2(2 * (w * z + x * y), 1 - 2 * (y * y + z * z)) };
+  }
+};
+
+}  // namespace linalg
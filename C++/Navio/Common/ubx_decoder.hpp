@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#include "./Ublox.h"
+
+/**
+ * @brief Table-driven decoding of UBX payloads.
+ * Every payload declares the wire offset and type of its fields once in a UbxLayout
+ * specialization. Decoding expands to one unaligned-safe memcpy load per field, byte-swapped only
+ * on big-endian hosts, so the compiler reduces it to plain loads on the Raspberry Pi.
+ */
+namespace ubx
+{
+template <typename T>
+constexpr T byteswap(T value)
+{
+  static_assert(std::is_integral_v<T>);
+
+  std::make_unsigned_t<T> in = value, out = 0;
+  for (size_t i = 0; i < sizeof(T); ++i)
+  {
+    out = (out << 8) | (in & 0xFF);
+    in >>= 8;
+  }
+  return static_cast<T>(out);
+}
+
+/** Load a little-endian value from an arbitrarily aligned address.
+ */
+template <typename T>
+inline T load(const uint8_t* src)
+{
+  if constexpr (std::is_floating_point_v<T>)
+  {
+    using Raw = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+    return std::bit_cast<T>(load<Raw>(src));
+  }
+  else
+  {
+    T value;
+    memcpy(&value, src, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big)
+      value = byteswap(value);
+    return value;
+  }
+}
+
+/**
+ * @tparam Member Destination member of the payload structure
+ * @tparam Wire Type of the field in the message (U1/I1/U2/I2/U4/I4/R4)
+ * @tparam Offset Byte offset of the field from the start of the payload
+ * @tparam Scale Factor from the wire unit to the member unit
+ */
+template <auto Member, typename Wire, size_t Offset, double Scale = 1.0>
+struct Field
+{
+  static constexpr size_t kEnd = Offset + sizeof(Wire);
+
+  template <typename Payload>
+  static void decode(const uint8_t* payload, Payload& data)
+  {
+    const Wire raw = load<Wire>(payload + Offset);
+    if constexpr (Scale == 1.0)
+      data.*Member = raw;
+    else
+      data.*Member = raw * Scale;
+  }
+};
+
+/**
+ * @tparam Member Destination member of the payload structure
+ * @tparam Offset Byte offset of the bitfield (X1) from the start of the payload
+ * @tparam Shift Position of the lowest bit
+ * @tparam Width Number of bits
+ */
+template <auto Member, size_t Offset, unsigned Shift, unsigned Width = 1>
+struct Bits
+{
+  static constexpr size_t kEnd = Offset + 1;
+
+  template <typename Payload>
+  static void decode(const uint8_t* payload, Payload& data)
+  {
+    data.*Member = (payload[Offset] >> Shift) & ((1u << Width) - 1);
+  }
+};
+
+template <typename... Fields>
+struct FieldList
+{
+  static constexpr size_t kLength = std::max({ size_t(0), Fields::kEnd... });
+
+  template <typename Payload>
+  static void decode(const uint8_t* payload, Payload& data)
+  {
+    (Fields::decode(payload, data), ...);
+  }
+};
+
+/* Specialized below for every payload: message ID, and the fields as a FieldList. */
+template <typename Payload>
+struct UbxLayout;
+
+/* UBX-NAV-POSLLH */
+template <>
+struct UbxLayout<NavPosllhPayload>
+{
+  using P = NavPosllhPayload;
+  static constexpr uint16_t kId = Ublox::NAV_POSLLH;
+  using Fields = FieldList<
+    Field<&P::lon, int32_t, 4, 1e-7>, Field<&P::lat, int32_t, 8, 1e-7>,
+    Field<&P::hMSL, int32_t, 16, 1e-3>>;
+};
+
+/* UBX-NAV-STATUS */
+template <>
+struct UbxLayout<NavStatusPayload>
+{
+  using P = NavStatusPayload;
+  static constexpr uint16_t kId = Ublox::NAV_STATUS;
+  using Fields = FieldList<Field<&P::gpsFix, uint8_t, 4>, Bits<&P::gpsFixOk, 5, 0>>;
+};
+
+/* UBX-NAV-DOP */
+template <>
+struct UbxLayout<NavDopPayload>
+{
+  using P = NavDopPayload;
+  static constexpr uint16_t kId = Ublox::NAV_DOP;
+  using Fields = FieldList<
+    Field<&P::gDOP, uint16_t, 4, 0.01>, Field<&P::pDOP, uint16_t, 6, 0.01>,
+    Field<&P::tDOP, uint16_t, 8, 0.01>, Field<&P::vDOP, uint16_t, 10, 0.01>,
+    Field<&P::hDOP, uint16_t, 12, 0.01>, Field<&P::nDOP, uint16_t, 14, 0.01>,
+    Field<&P::eDOP, uint16_t, 16, 0.01>>;
+};
+
+/* UBX-NAV-PVT */
+template <>
+struct UbxLayout<NavPvtPayload>
+{
+  using P = NavPvtPayload;
+  static constexpr uint16_t kId = Ublox::NAV_PVT;
+  using Fields = FieldList<
+    Field<&P::year, uint16_t, 4>, Field<&P::month, uint8_t, 6>, Field<&P::day, uint8_t, 7>,
+    Field<&P::hour, uint8_t, 8>, Field<&P::min, uint8_t, 9>, Field<&P::sec, uint8_t, 10>,
+    Bits<&P::validDate, 11, 0>, Bits<&P::validTime, 11, 1>, Bits<&P::fullyResolved, 11, 2>,
+    Bits<&P::validMag, 11, 3>, Field<&P::tAcc, uint32_t, 12>, Field<&P::nano, int32_t, 16>,
+    Field<&P::fixType, uint8_t, 20>, Bits<&P::gnssFixOk, 21, 0>,
+    Field<&P::lon, int32_t, 24, 1e-7>, Field<&P::lat, int32_t, 28, 1e-7>,
+    Field<&P::hMSL, int32_t, 36, 1e-3>, Field<&P::velN, int32_t, 48, 1e-3>,
+    Field<&P::velE, int32_t, 52, 1e-3>, Field<&P::velD, int32_t, 56, 1e-3>>;
+};
+
+/* UBX-NAV-VELNED */
+template <>
+struct UbxLayout<NavVelnedPayload>
+{
+  using P = NavVelnedPayload;
+  static constexpr uint16_t kId = Ublox::NAV_VELNED;
+  using Fields = FieldList<
+    Field<&P::velN, int32_t, 4, 1e-2>, Field<&P::velE, int32_t, 8, 1e-2>,
+    Field<&P::velD, int32_t, 12, 1e-2>>;
+};
+
+/* UBX-NAV-TIMEGPS */
+template <>
+struct UbxLayout<NavTimegpsPayload>
+{
+  using P = NavTimegpsPayload;
+  static constexpr uint16_t kId = Ublox::NAV_TIMEGPS;
+  using Fields = FieldList<
+    Field<&P::iTOW, uint32_t, 0>, Field<&P::fTOW, int32_t, 4>, Field<&P::week, int16_t, 8>,
+    Field<&P::leapS, int8_t, 10>, Bits<&P::towValid, 11, 0>, Bits<&P::weekValid, 11, 1>,
+    Bits<&P::leapSValid, 11, 2>, Field<&P::tAcc, uint32_t, 12>>;
+};
+
+/* UBX-NAV-TIMEUTC */
+template <>
+struct UbxLayout<NavTimeutcPayload>
+{
+  using P = NavTimeutcPayload;
+  static constexpr uint16_t kId = Ublox::NAV_TIMEUTC;
+  using Fields = FieldList<
+    Field<&P::tAcc, uint32_t, 4>, Field<&P::nano, int32_t, 8>, Field<&P::year, uint16_t, 12>,
+    Field<&P::month, uint8_t, 14>, Field<&P::day, uint8_t, 15>, Field<&P::hour, uint8_t, 16>,
+    Field<&P::min, uint8_t, 17>, Field<&P::sec, uint8_t, 18>, Bits<&P::validUTC, 19, 2>>;
+};
+
+/* UBX-NAV-COV */
+template <>
+struct UbxLayout<NavCovPayload>
+{
+  using P = NavCovPayload;
+  static constexpr uint16_t kId = Ublox::NAV_COV;
+  using Fields = FieldList<
+    Field<&P::posCovNN, float, 16>, Field<&P::posCovNE, float, 20>,
+    Field<&P::posCovND, float, 24>, Field<&P::posCovEE, float, 28>,
+    Field<&P::posCovED, float, 32>, Field<&P::posCovDD, float, 36>,
+    Field<&P::velCovNN, float, 40>, Field<&P::velCovNE, float, 44>,
+    Field<&P::velCovND, float, 48>, Field<&P::velCovEE, float, 52>,
+    Field<&P::velCovED, float, 56>, Field<&P::velCovDD, float, 60>>;
+};
+
+/* UBX-ACK-NAK */
+template <>
+struct UbxLayout<AckNakPayload>
+{
+  using P = AckNakPayload;
+  static constexpr uint16_t kId = Ublox::ACK_NAK;
+  using Fields = FieldList<Field<&P::clsID, uint8_t, 0>, Field<&P::msgID, uint8_t, 1>>;
+};
+
+/* UBX-ACK-ACK */
+template <>
+struct UbxLayout<AckAckPayload>
+{
+  using P = AckAckPayload;
+  static constexpr uint16_t kId = Ublox::ACK_ACK;
+  using Fields = FieldList<Field<&P::clsID, uint8_t, 0>, Field<&P::msgID, uint8_t, 1>>;
+};
+
+/* UBX-MON-HW */
+template <>
+struct UbxLayout<MonHwPayload>
+{
+  using P = MonHwPayload;
+  static constexpr uint16_t kId = Ublox::MON_HW;
+  using Fields = FieldList<
+    Field<&P::noisePerMS, uint16_t, 16>, Field<&P::agcCnt, uint16_t, 18>,
+    Field<&P::aStatus, uint8_t, 20>, Field<&P::aPower, uint8_t, 21>, Bits<&P::rtcCalib, 22, 0>,
+    Bits<&P::safeBoot, 22, 1>, Bits<&P::jammingState, 22, 2, 2>, Bits<&P::xtalAbsent, 22, 4>,
+    Field<&P::jamInd, uint8_t, 45>>;
+};
+
+/* UBX-MON-HW2 */
+template <>
+struct UbxLayout<MonHw2Payload>
+{
+  using P = MonHw2Payload;
+  static constexpr uint16_t kId = Ublox::MON_HW2;
+  using Fields = FieldList<
+    Field<&P::ofsI, int8_t, 0>, Field<&P::magI, uint8_t, 1>, Field<&P::ofsQ, int8_t, 2>,
+    Field<&P::magQ, uint8_t, 3>, Field<&P::cfgSource, uint8_t, 4>,
+    Field<&P::postStatus, uint32_t, 20>>;
+};
+
+}  // namespace ubx
@@ -71,3 +71,53 @@ ostream& operator<<(ostream& os, const NavCovPayload& arg)
   os << "Velocity covariance matrix value v_DD: " << arg.velCovDD << "[m^2/s^2]" << endl;
   return os;
 }
+
+ostream& operator<<(ostream& os, const NavDopPayload& arg)
+{
+  os << "Geometric DOP: " << arg.gDOP << endl;
+  os << "Position DOP: " << arg.pDOP << endl;
+  os << "Time DOP: " << arg.tDOP << endl;
+  os << "Vertical DOP: " << arg.vDOP << endl;
+  os << "Horizontal DOP: " << arg.hDOP << endl;
+  os << "Northing DOP: " << arg.nDOP << endl;
+  os << "Easting DOP: " << arg.eDOP << endl;
+  return os;
+}
+
+ostream& operator<<(ostream& os, const NavTimegpsPayload& arg)
+{
+  os << "GPS time of week: " << arg.iTOW << "[ms]" << endl;
+  os << "Fractional part of iTOW: " << arg.fTOW << "[ns]" << endl;
+  os << "GPS week number: " << arg.week << endl;
+  os << "GPS leap seconds: " << static_cast<int>(arg.leapS) << "[s]" << endl;
+  os << "Valid GPS time of week: " << arg.towValid << endl;
+  os << "Valid GPS week number: " << arg.weekValid << endl;
+  os << "Valid GPS leap seconds: " << arg.leapSValid << endl;
+  os << "Time accuracy estimate: " << arg.tAcc << "[ns]" << endl;
+  return os;
+}
+
+ostream& operator<<(ostream& os, const MonHwPayload& arg)
+{
+  os << "Noise level: " << arg.noisePerMS << endl;
+  os << "AGC monitor: " << arg.agcCnt << endl;
+  os << "Antenna status: " << static_cast<int>(arg.aStatus) << endl;
+  os << "Antenna power: " << static_cast<int>(arg.aPower) << endl;
+  os << "RTC is calibrated: " << arg.rtcCalib << endl;
+  os << "Safe boot mode: " << arg.safeBoot << endl;
+  os << "Jamming state: " << static_cast<int>(arg.jammingState) << endl;
+  os << "RTC xtal absent: " << arg.xtalAbsent << endl;
+  os << "CW jamming indicator: " << static_cast<int>(arg.jamInd) << endl;
+  return os;
+}
+
+ostream& operator<<(ostream& os, const MonHw2Payload& arg)
+{
+  os << "Imbalance of I-part: " << static_cast<int>(arg.ofsI) << endl;
+  os << "Magnitude of I-part: " << static_cast<int>(arg.magI) << endl;
+  os << "Imbalance of Q-part: " << static_cast<int>(arg.ofsQ) << endl;
+  os << "Magnitude of Q-part: " << static_cast<int>(arg.magQ) << endl;
+  os << "Low-level configuration source: " << static_cast<int>(arg.cfgSource) << endl;
+  os << "POST status word: " << arg.postStatus << endl;
+  return os;
+}
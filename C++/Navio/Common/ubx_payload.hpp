@@ -5,6 +5,8 @@
 
 struct NavPosllhPayload
 {
+  uint64_t timestamp;  // Reception time, CLOCK_MONOTONIC_RAW [ns]
+
   double lon;   // Longitude [deg]
   double lat;   // Latitude [deg]
   double hMSL;  // Height above mean sea level [m]
@@ -14,6 +16,8 @@ struct NavPosllhPayload
 
 struct NavStatusPayload
 {
+  uint64_t timestamp;  // Reception time, CLOCK_MONOTONIC_RAW [ns]
+
   uint8_t gpsFix;  // GPSfix Type, this value does not qualify a fix as valid and within the limits
   bool gpsFixOk;   // Position and velocity valid and within DOP and ACC Masks
 
@@ -22,11 +26,23 @@ struct NavStatusPayload
 
 struct NavDopPayload
 {
-  // TODO
+  uint64_t timestamp;  // Reception time, CLOCK_MONOTONIC_RAW [ns]
+
+  double gDOP;  // Geometric DOP
+  double pDOP;  // Position DOP
+  double tDOP;  // Time DOP
+  double vDOP;  // Vertical DOP
+  double hDOP;  // Horizontal DOP
+  double nDOP;  // Northing DOP
+  double eDOP;  // Easting DOP
+
+  friend std::ostream& operator<<(std::ostream& os, const NavDopPayload& arg);
 };
 
 struct NavPvtPayload
 {
+  uint64_t timestamp;  // Reception time, CLOCK_MONOTONIC_RAW [ns]
+
   uint16_t year;  // Year (UTC) [y]
   uint8_t month;  // Month, range 1..12 (UTC) [month]
   uint8_t day;    // Day of month, range 1..31 (UTC) [d]
@@ -58,6 +74,8 @@ struct NavPvtPayload
 
 struct NavVelnedPayload
 {
+  uint64_t timestamp;  // Reception time, CLOCK_MONOTONIC_RAW [ns]
+
   double velN;  // North velocity component [m/s]
   double velE;  // East velocity component [m/s]
   double velD;  // Down velocity component [m/s]
@@ -67,11 +85,26 @@ struct NavVelnedPayload
 
 struct NavTimegpsPayload
 {
-  // TODO
+  uint64_t timestamp;  // Reception time, CLOCK_MONOTONIC_RAW [ns]
+
+  uint32_t iTOW;  // GPS time of week of the navigation epoch [ms]
+  int fTOW;       // Fractional part of iTOW, range -500000..500000 [ns]
+  int16_t week;   // GPS week number of the navigation epoch [weeks]
+  int8_t leapS;   // GPS leap seconds (GPS-UTC) [s]
+
+  bool towValid;    // Valid GPS time of week (iTOW & fTOW)
+  bool weekValid;   // Valid GPS week number
+  bool leapSValid;  // Valid GPS leap seconds
+
+  uint32_t tAcc;  // Time accuracy estimate [ns]
+
+  friend std::ostream& operator<<(std::ostream& os, const NavTimegpsPayload& arg);
 };
 
 struct NavTimeutcPayload
 {
+  uint64_t timestamp;  // Reception time, CLOCK_MONOTONIC_RAW [ns]
+
   uint32_t tAcc;  // Time accuracy estimate (UTC) [ns]
   int nano;       // Fraction of second, range -1e9 .. 1e9 (UTC) [ns]
   uint16_t year;  // Year (UTC) [y]
@@ -86,6 +119,8 @@ struct NavTimeutcPayload
 
 struct NavCovPayload
 {
+  uint64_t timestamp;  // Reception time, CLOCK_MONOTONIC_RAW [ns]
+
   double posCovNN;  // Position covariance matrix value p_NN [m^2]
   double posCovNE;  // Position covariance matrix value p_NE [m^2]
   double posCovND;  // Position covariance matrix value p_ND [m^2]
@@ -116,10 +151,29 @@ struct AckAckPayload
 
 struct MonHwPayload
 {
-  // TODO
+  uint16_t noisePerMS;  // Noise level as measured by the GPS core
+  uint16_t agcCnt;      // AGC monitor, range 0..8191
+  uint8_t aStatus;      // Antenna supervisor state (0=INIT, 1=DONTKNOW, 2=OK, 3=SHORT, 4=OPEN)
+  uint8_t aPower;       // Antenna power status (0=OFF, 1=ON, 2=DONTKNOW)
+
+  bool rtcCalib;         // RTC is calibrated
+  bool safeBoot;         // Safe boot mode
+  uint8_t jammingState;  // Jamming monitor output (0=unknown, 1=ok, 2=warning, 3=critical)
+  bool xtalAbsent;       // RTC xtal has been determined to be absent
+
+  uint8_t jamInd;  // CW jamming indicator, scaled (0=no CW jamming, 255=strong CW jamming)
+
+  friend std::ostream& operator<<(std::ostream& os, const MonHwPayload& arg);
 };
 
 struct MonHw2Payload
 {
-  // TODO
+  int8_t ofsI;          // Imbalance of I-part of complex signal (-128..127)
+  uint8_t magI;         // Magnitude of I-part of complex signal (0=no signal, 255=max.)
+  int8_t ofsQ;          // Imbalance of Q-part of complex signal (-128..127)
+  uint8_t magQ;         // Magnitude of Q-part of complex signal (0=no signal, 255=max.)
+  uint8_t cfgSource;    // Source of low-level configuration (114=ROM, 111=OTP, 112=pins, 102=flash)
+  uint32_t postStatus;  // POST status word
+
+  friend std::ostream& operator<<(std::ostream& os, const MonHw2Payload& arg);
 };
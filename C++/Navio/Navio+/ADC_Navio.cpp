@@ -1,3 +1,5 @@
+#include <unistd.h>
+
 #include "./ADC_Navio.h"
 
 ADC_Navio::ADC_Navio()
@@ -6,23 +8,34 @@ ADC_Navio::ADC_Navio()
 
 void ADC_Navio::initialize()
 {
-  ADS1115 adc;
-
-  adc.setMode(ADS1115_MODE_SINGLESHOT);
   adc.setRate(ADS1115_RATE_860);
+  adc.configureSampler(muxes);
+
+  // Take one round so read() has a value for every channel from the start
+  for (size_t finished = 0; finished < ARRAY_SIZE(muxes);)
+  {
+    if (adc.tick())
+      ++finished;
+    else
+      usleep(adc.getConversionTime() / 1000);
+  }
 }
 
 int ADC_Navio::read(int ch)
 {
-  if (static_cast<size_t>(ch) > ARRAY_SIZE(muxes))
+  if (ch < 0 || static_cast<size_t>(ch) >= ARRAY_SIZE(muxes))
   {
     fprintf(stderr, "Channel number too large\n");
     return -1;
   }
-  adc.setMultiplexer(muxes[ch]);
 
-  float conversion = adc.getMilliVolts();
-  results[ch % ARRAY_SIZE(muxes)] = conversion;
+  adc.tick();
+
+  ADS1115Sample sample;
+  if (adc.getSample(ch, sample))
+  {
+    results[ch] = sample.milliVolts;
+  }
   return results[ch];
 }
 
@@ -10,6 +10,11 @@ public:
   explicit ADC_Navio();
   void initialize() override;
   int get_channel_count(void) override;
+
+  /** Advance the round-robin sampler and return the latest conversion of a channel.
+   * Never waits for a conversion, the value is at most one round old when read() is called at
+   * least once per conversion.
+   */
   int read(int ch) override;
 
 private:
@@ -1,9 +1,17 @@
 #include <unistd.h>
 #include <string.h>
 #include <stdio.h>
+#include <algorithm>
 
+#include "../Common/Util.h"
 #include "ADS1115.h"
 
+namespace
+{
+constexpr uint32_t kRates[] = { 8, 16, 32, 64, 128, 250, 475, 860 };  // [SPS]
+constexpr uint64_t kWakeUpNs = 50000;  // Power-up of a single-shot conversion
+}  // namespace
+
 ADS1115::ADS1115(uint8_t address)
 {
   this->address = address;
@@ -26,31 +34,44 @@ bool ADS1115::testConnection()
 
 int16_t ADS1115::getConversion()
 {
-  union
-  {
-    uint16_t w;
-    uint8_t b[2];
-  } word;
-  word.w = 0;
+  uint16_t status = 0;
 
   if (config.mode == ADS1115_MODE_SINGLESHOT)
   {
-    /* Check for Operation Status. If it is 0 then we are ready to get data. Otherwise wait. */
+    /* Sleep through the conversion, then check for Operation Status. If it is 0 then we are ready
+     * to get data. Otherwise wait. */
     setOpStatus(ADS1115_OS_ACTIVE);
-    while ((word.w & 0x80) == 0)
+    usleep(getConversionTime() / 1000);
+    while ((status & 0x80) == 0)
     {
-      if (I2Cdev::readWord(address, ADS1115_RA_CONFIG, &word.w) < 0)
+      if (I2Cdev::readWord(address, ADS1115_RA_CONFIG, &status) < 0)
         fprintf(stderr, "Error while reading config\n");
     }
   }
 
-  if ((I2Cdev::readWord(address, ADS1115_RA_CONVERSION, &word.w)) < 0)
+  int16_t value = 0;
+  if (!readConversion(value))
   {
     fprintf(stderr, "Error while reading\n");
   }
+  return value;
+}
+
+bool ADS1115::readConversion(int16_t& value)
+{
+  union
+  {
+    uint16_t w;
+    uint8_t b[2];
+  } word;
+
+  if (I2Cdev::readWord(address, ADS1115_RA_CONVERSION, &word.w) < 0)
+  {
+    return false;
+  }
   /* Exchange MSB and LSB */
-  word.w = word.b[0] << 8 | word.b[1];
-  return (int16_t)word.w;
+  value = static_cast<int16_t>(word.b[0] << 8 | word.b[1]);
+  return true;
 }
 
 void ADS1115::setOpStatus(uint16_t status)
@@ -117,32 +138,35 @@ void ADS1115::setRate(uint16_t rate)
 
 float ADS1115::getMilliVolts()
 {
-  switch (config.gain)
+  const float scale = getMilliVoltsPerBit(config.gain);
+  if (scale < 0)
+  {
+    fprintf(stderr, "Wrong gain\n");
+    return -1;
+  }
+  return getConversion() * scale;
+}
+
+float ADS1115::getMilliVoltsPerBit(uint16_t gain)
+{
+  switch (gain)
   {
     case ADS1115_PGA_6P144:
-      return (getConversion() * ADS1115_MV_6P144);
-      break;
+      return ADS1115_MV_6P144;
     case ADS1115_PGA_4P096:
-      return (getConversion() * ADS1115_MV_4P096);
-      break;
+      return ADS1115_MV_4P096;
     case ADS1115_PGA_2P048:
-      return (getConversion() * ADS1115_MV_2P048);
-      break;
+      return ADS1115_MV_2P048;
     case ADS1115_PGA_1P024:
-      return (getConversion() * ADS1115_MV_1P024);
-      break;
+      return ADS1115_MV_1P024;
     case ADS1115_PGA_0P512:
-      return (getConversion() * ADS1115_MV_0P512);
-      break;
+      return ADS1115_MV_0P512;
     case ADS1115_PGA_0P256:
     case ADS1115_PGA_0P256B:
     case ADS1115_PGA_0P256C:
-      return (getConversion() * ADS1115_MV_0P256);
-      break;
+      return ADS1115_MV_0P256;
     default:
-      fprintf(stderr, "Wrong gain\n");
       return -1;
-      break;
   }
 }
 
@@ -182,6 +206,72 @@ void ADS1115::setComparatorQueueMode(uint16_t queue)
   }
 }
 
+void ADS1115::configureSampler(std::span<const uint16_t> muxes)
+{
+  samplerCount = std::min(muxes.size(), kMaxSamplerChannels);
+  std::copy_n(muxes.begin(), samplerCount, samplerMuxes);
+  samplerIndex = 0;
+  samplerConverting = false;
+  sampledChannels = 0;
+}
+
+bool ADS1115::tick()
+{
+  if (samplerCount == 0 || (samplerConverting && get_time_ns() < conversionEnd))
+  {
+    return false;
+  }
+
+  const bool finished = samplerConverting;
+  if (finished)
+  {
+    int16_t value;
+    if (readConversion(value))
+    {
+      auto& sample = samples[samplerIndex];
+      sample.timestamp = conversionStart + (conversionEnd - conversionStart) / 2;
+      sample.raw = value;
+      sample.milliVolts = value * getMilliVoltsPerBit(config.gain);
+      sampledChannels |= 1u << samplerIndex;
+    }
+    samplerIndex = (samplerIndex + 1) % samplerCount;
+  }
+
+  startConversion(samplerMuxes[samplerIndex]);
+  return finished;
+}
+
+bool ADS1115::getSample(size_t channel, ADS1115Sample& sample) const
+{
+  if (channel >= samplerCount || !(sampledChannels & (1u << channel)))
+  {
+    return false;
+  }
+
+  sample = samples[channel];
+  return true;
+}
+
+uint64_t ADS1115::getConversionTime() const
+{
+  const uint32_t rate = kRates[config.rate >> ADS1115_RATE_SHIFT];
+  return 1100000000 / rate + kWakeUpNs;
+}
+
+void ADS1115::startConversion(uint16_t mux)
+{
+  /* Selecting the input and starting the conversion is a single config write */
+  config.mux = mux;
+  config.mode = ADS1115_MODE_SINGLESHOT;
+  config.status = ADS1115_OS_ACTIVE;
+  updateConfigRegister();
+  config.status = ADS1115_OS_INACTIVE;
+
+  conversionStart = get_time_ns();
+  conversionEnd = conversionStart + getConversionTime();
+  samplerConverting = true;
+}
+
 void ADS1115::updateConfigRegister()
 {
   uint16_t c;
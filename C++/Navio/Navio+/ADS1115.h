@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <span>
 #include <string>
 
 #ifdef DEBUG_ADS1115
@@ -86,9 +88,18 @@
 
 #include "../Common/I2Cdev.h"
 
+struct ADS1115Sample
+{
+  uint64_t timestamp;  // Middle of the conversion, CLOCK_MONOTONIC_RAW [ns]
+  int16_t raw;         // Content of the conversion register
+  float milliVolts;    // raw scaled by the gain it was converted with
+};
+
 class ADS1115
 {
 public:
+  static constexpr size_t kMaxSamplerChannels = 8;
+
   /**
    * @brief ADS1115 constructor
    * Default gain is 4096
@@ -210,7 +221,43 @@ public:
    */
   void setComparatorQueueMode(uint16_t queueMode);
 
+  /**
+   * @brief Sample several inputs in turn from tick()
+   * Every conversion is started by one config write that also selects its input, and read once
+   * its conversion time has elapsed, so no I2C polling is needed. The ALERT/RDY pin is not
+   * routed to the Raspberry Pi on Navio+.
+   *
+   * @param muxes Multiplexer setting of every channel, at most kMaxSamplerChannels
+   */
+  void configureSampler(std::span<const uint16_t> muxes);
+
+  /**
+   * @brief Advance the sampler without blocking
+   * Collects the finished conversion, if any, and starts the next channel.
+   *
+   * @return True if a conversion finished, even if reading it failed
+   */
+  bool tick();
+
+  /**
+   * @brief Latest sample of a sampler channel
+   *
+   * @return False if the channel has not been read successfully yet
+   */
+  bool getSample(size_t channel, ADS1115Sample& sample) const;
+
+  /**
+   * @brief Duration of one conversion at the current rate, with margin for the +/-10% oscillator
+   * tolerance
+   */
+  uint64_t getConversionTime() const;
+
 private:
+  static float getMilliVoltsPerBit(uint16_t gain);
+
+  bool readConversion(int16_t& value);
+  void startConversion(uint16_t mux);
+
   /**
    * @brief Call it if you updated ConfigRegister
    */
@@ -230,4 +277,13 @@ private:
     uint16_t latch;
     uint16_t queue;
   } config;
+
+  uint16_t samplerMuxes[kMaxSamplerChannels];
+  size_t samplerCount = 0;
+  size_t samplerIndex = 0;  // Channel being converted
+  bool samplerConverting = false;
+  uint64_t conversionStart;
+  uint64_t conversionEnd;
+  ADS1115Sample samples[kMaxSamplerChannels];
+  uint32_t sampledChannels = 0;  // Bit per channel with a valid sample
 };
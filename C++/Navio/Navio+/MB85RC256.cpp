@@ -1,3 +1,5 @@
+#include <cstring>
+
 #include "../Common/I2Cdev.h"
 #include "./MB85RC256.h"
 
@@ -6,39 +8,47 @@ MB85RC256::MB85RC256(uint8_t address)
   this->device_address = address;
 }
 
-uint8_t MB85RC256::readByte(uint16_t register_address, uint8_t* data)
+bool MB85RC256::readByte(uint16_t register_address, uint8_t* data)
 {
   return MB85RC256::readBytes(register_address, 1, data);
 }
 
-uint8_t MB85RC256::writeByte(uint16_t register_address, uint8_t data)
+bool MB85RC256::writeByte(uint16_t register_address, uint8_t data)
 {
   return MB85RC256::writeBytes(register_address, 1, &data);
 }
 
-uint8_t MB85RC256::writeBytes(uint16_t register_address, uint8_t length, uint8_t* data)
+bool MB85RC256::writeBytes(uint16_t register_address, uint16_t length, const uint8_t* data)
 {
-  uint8_t reg_address_low = register_address;        // lower part of the address
-  uint8_t reg_address_high = register_address >> 8;  // higher part of the address
-  uint8_t msg[length + 1];
-
-  msg[0] = reg_address_low;
+  // The address and the data must be one message, a repeated start would begin a new command
+  uint8_t msg[2 + kWriteChunk];
 
-  for (int i = 0; i < length; ++i)
+  while (length > 0)
   {
-    msg[i + 1] = data[i];
+    const uint16_t chunk = length < kWriteChunk ? length : kWriteChunk;
+    msg[0] = register_address >> 8;  // higher part of the address
+    msg[1] = register_address;       // lower part of the address
+    memcpy(msg + 2, data, chunk);
+
+    if (!I2Cbus::instance().transfer(this->device_address, msg, chunk + 2, nullptr, 0))
+    {
+      return false;
+    }
+
+    register_address += chunk;
+    data += chunk;
+    length -= chunk;
   }
-
-  return I2Cdev::writeBytes(this->device_address, reg_address_high, length + 1, msg);
+  return true;
 }
 
-uint8_t MB85RC256::readBytes(uint16_t register_address, uint8_t length, uint8_t* data)
+bool MB85RC256::readBytes(uint16_t register_address, uint16_t length, uint8_t* data)
 {
-  uint8_t reg_address_low = register_address;        // lower part of the address
-  uint8_t reg_address_high = register_address >> 8;  // higher part of the address
-
-  // set the read pointer to the desired address
-  I2Cdev::writeByte(this->device_address, reg_address_high, reg_address_low);
+  const uint8_t reg_address[2] = {
+    static_cast<uint8_t>(register_address >> 8),  // higher part of the address
+    static_cast<uint8_t>(register_address),       // lower part of the address
+  };
 
-  return I2Cdev::readBytesNoRegAddress(this->device_address, length, data);
+  // set the read pointer to the desired address and read from it with a repeated start
+  return I2Cbus::instance().transfer(this->device_address, reg_address, 2, data, length);
 }
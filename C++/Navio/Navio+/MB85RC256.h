@@ -1,15 +1,36 @@
 #pragma once
 
 #include <cinttypes>
+#include <cstddef>
 
+/**
+ * @brief Fujitsu MB85RC256V 32 KB I2C FRAM.
+ * Writes take effect at bus speed, need no erase and endure 10^12 cycles per byte, so data can be
+ * updated in place. Transfers of any length wrap around at the end of the memory.
+ */
 class MB85RC256
 {
+  static constexpr size_t kWriteChunk = 256;  // Data bytes per write transaction
+
   uint8_t device_address;
 
 public:
+  static constexpr size_t kSize = 32768;
+
   explicit MB85RC256(uint8_t address = 0b1010000);
-  uint8_t readByte(uint16_t register_address, uint8_t* data);
-  uint8_t writeByte(uint16_t register_address, uint8_t data);
-  uint8_t readBytes(uint16_t register_address, uint8_t length, uint8_t* data);
-  uint8_t writeBytes(uint16_t register_address, uint8_t length, uint8_t* data);
+
+  /** @return Status of the transfer (true = success)
+   */
+  bool readByte(uint16_t register_address, uint8_t* data);
+  bool writeByte(uint16_t register_address, uint8_t data);
+
+  /** Read length bytes in one transaction.
+   * @return Status of the transfer (true = success)
+   */
+  bool readBytes(uint16_t register_address, uint16_t length, uint8_t* data);
+
+  /** Write length bytes, split into transactions of at most kWriteChunk bytes.
+   * @return Status of the transfers (true = success)
+   */
+  bool writeBytes(uint16_t register_address, uint16_t length, const uint8_t* data);
 };
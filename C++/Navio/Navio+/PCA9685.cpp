@@ -1,5 +1,6 @@
 #include <unistd.h>
 #include <math.h>
+#include <algorithm>
 
 #include "../Common/I2Cdev.h"
 #include "./PCA9685.h"
@@ -59,9 +60,9 @@ void PCA9685::setFrequency(float frequency)
   restart();
 }
 
-void PCA9685::setPWM(uint8_t channel, uint16_t offset, uint16_t length)
+void PCA9685::encodePWM(uint8_t* data, uint16_t offset, uint16_t length)
 {
-  uint8_t data[4] = { 0, 0, 0, 0 };
+  data[0] = data[1] = data[2] = data[3] = 0;
   if (length == 0)
   {
     data[3] = 0x10;
@@ -77,6 +78,12 @@ void PCA9685::setPWM(uint8_t channel, uint16_t offset, uint16_t length)
     data[2] = length & 0xFF;
     data[3] = length >> 8;
   }
+}
+
+void PCA9685::setPWM(uint8_t channel, uint16_t offset, uint16_t length)
+{
+  uint8_t data[4];
+  encodePWM(data, offset, length);
   I2Cdev::writeBytes(devAddr, PCA9685_RA_LED0_ON_L + 4 * channel, 4, data);
 }
 
@@ -95,6 +102,37 @@ void PCA9685::setPWMuS(uint8_t channel, float length_uS)
   setPWM(channel, round((length_uS * 4096.f) / (1000000.f / frequency)));
 }
 
+bool PCA9685::setPWMs(uint8_t first_channel, std::span<const uint16_t> lengths)
+{
+  if (first_channel >= kChannels)
+  {
+    return false;
+  }
+  if (lengths.empty())
+  {
+    return true;
+  }
+
+  uint8_t data[4 * kChannels];
+  const size_t count = std::min<size_t>(lengths.size(), kChannels - first_channel);
+  for (size_t i = 0; i < count; ++i)
+  {
+    encodePWM(data + 4 * i, 0, lengths[i]);
+  }
+  return I2Cdev::writeBytes(devAddr, PCA9685_RA_LED0_ON_L + 4 * first_channel, 4 * count, data);
+}
+
+bool PCA9685::setPWMsuS(uint8_t first_channel, std::span<const double> lengths_uS)
+{
+  uint16_t lengths[kChannels];
+  const size_t count = std::min<size_t>(lengths_uS.size(), kChannels);
+  for (size_t i = 0; i < count; ++i)
+  {
+    lengths[i] = round((lengths_uS[i] * 4096.f) / (1000000.f / frequency));
+  }
+  return setPWMs(first_channel, { lengths, count });
+}
+
 void PCA9685::setAllPWM(uint16_t offset, uint16_t length)
 {
   uint8_t data[4] = { static_cast<uint8_t>(offset & 0xFF), static_cast<uint8_t>(offset >> 8),
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cinttypes>
+#include <span>
 
 #define PCA9685_DEFAULT_ADDRESS 0x40  // All address pins low, Navio default
 
@@ -104,6 +105,24 @@ public:
    */
   void setPWMuS(uint8_t channel, float length_uS);
 
+  /** Set pulse lengths of consecutive channels in a single I2C transaction
+   * Relies on the register auto-increment enabled by initialize().
+   * @param First channel number (0-15)
+   * @param Lengths (0-4095) of first_channel, first_channel + 1, ..., ignored if they run past
+   * channel 15
+   * @return False if first_channel is out of range or the I2C write fails
+   * @see PCA9685_RA_LED0_ON_L
+   */
+  bool setPWMs(uint8_t first_channel, std::span<const uint16_t> lengths);
+
+  /** Set pulse lengths of consecutive channels in microseconds in a single I2C transaction
+   * @param First channel number (0-15)
+   * @param Lengths in microseconds
+   * @return False if first_channel is out of range or the I2C write fails
+   * @see PCA9685_RA_LED0_ON_L
+   */
+  bool setPWMsuS(uint8_t first_channel, std::span<const double> lengths_uS);
+
   /** Set start offset of the pulse and it's length for all channels
    * @param Offset (0-4095)
    * @param Length (0-4095)
@@ -130,6 +149,12 @@ public:
   void setAllPWMuS(float length_uS);
 
 private:
+  static constexpr uint8_t kChannels = 16;
+
   uint8_t devAddr;
   float frequency;
+
+  /** Fill the 4 LEDn_ON/LEDn_OFF register values of one channel
+   */
+  static void encodePWM(uint8_t* data, uint16_t offset, uint16_t length);
 };
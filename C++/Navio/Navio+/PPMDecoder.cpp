@@ -0,0 +1,92 @@
+#include <cmath>
+#include <cstring>
+
+#include "./PPMDecoder.h"
+
+PPMDecoder::PPMDecoder(uint32_t channel_count, uint32_t sync_length)
+  : channel_count_(channel_count < RCFrame::kMaxChannels ? channel_count : RCFrame::kMaxChannels),
+    sync_length_(sync_length)
+{
+  reset(0);
+  previous_time_ns_ = 0;
+  sequence_ = 0;
+  memset(&stats_, 0, sizeof(PPMStats));
+}
+
+void PPMDecoder::reset(uint32_t tick)
+{
+  previous_tick_ = tick;
+  synced_ = false;
+  current_channel_ = 0;
+}
+
+void PPMDecoder::onEdge(uint32_t tick, uint64_t time_ns)
+{
+  const uint32_t delta = tick - previous_tick_;
+  previous_tick_ = tick;
+  previous_time_ns_ = time_ns;
+
+  if (delta >= sync_length_)
+  {
+    if (synced_ && current_channel_ != 0)
+      ++stats_.dropped_frames;  // Sync pause before the last channel
+    synced_ = true;
+    current_channel_ = 0;
+    return;
+  }
+
+  if (!synced_)
+  {
+    return;
+  }
+
+  pending_[current_channel_++] = delta;
+  if (current_channel_ == channel_count_)
+  {
+    publishFrame();
+    synced_ = false;  // Pulses after the last channel are ignored until the next sync
+    current_channel_ = 0;
+  }
+}
+
+bool PPMDecoder::latest(RCFrame& frame) const
+{
+  return frames_.latest(frame);
+}
+
+bool PPMDecoder::getStats(PPMStats& stats) const
+{
+  return published_stats_.latest(stats);
+}
+
+void PPMDecoder::publishFrame()
+{
+  RCFrame frame;
+  memset(&frame, 0, sizeof(RCFrame));
+  frame.timestamp = previous_time_ns_;
+  frame.sequence = ++sequence_;
+  frame.channel_count = channel_count_;
+  memcpy(frame.channels, pending_, channel_count_ * sizeof(uint16_t));
+
+  RCFrame previous;
+  const bool has_previous = frames_.latest(previous);
+  for (uint32_t i = 0; i < channel_count_; ++i)
+  {
+    auto& channel = stats_.channels[i];
+    const uint16_t value = pending_[i];
+    if (!has_previous)
+    {
+      channel.min = channel.max = value;
+      continue;
+    }
+
+    channel.min = value < channel.min ? value : channel.min;
+    channel.max = value > channel.max ? value : channel.max;
+    const float change = std::fabs(static_cast<float>(value) - previous.channels[i]);
+    channel.jitter += kJitterGain * (change - channel.jitter);
+  }
+  ++stats_.frames;
+
+  frames_.publish(frame);
+  published_stats_.publish(stats_);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+
+#include "../Common/RCInput.h"
+#include "../Common/SampleRing.h"
+
+struct PPMStats
+{
+  struct Channel
+  {
+    uint16_t min, max;  // Extremes since the first frame [us]
+    float jitter;       // Moving average of the change between consecutive frames [us]
+  };
+
+  uint32_t frames;          // Complete frames published
+  uint32_t dropped_frames;  // Frames cut short by a sync pause
+  Channel channels[RCFrame::kMaxChannels];
+};
+
+/**
+ * @brief PPM decoder fed with the ticks of falling edges.
+ * A frame is assembled privately and published as a whole once its last channel is measured, so a
+ * reader on another thread never sees channels of two different frames. Ticks are plain
+ * microsecond counters, which lets tests feed synthetic edges without pigpio.
+ */
+class PPMDecoder
+{
+  static constexpr float kJitterGain = 1.f / 16;
+
+public:
+  /**
+   * @param channel_count Number of channels packed in a frame, at most RCFrame::kMaxChannels
+   * @param sync_length Shortest interval treated as the sync pause [us]
+   */
+  explicit PPMDecoder(uint32_t channel_count = 8, uint32_t sync_length = 4000);
+
+  /** Wait for the next sync pause.
+   * @param tick Current value of the microsecond tick counter
+   */
+  void reset(uint32_t tick);
+
+  /** Process one falling edge. Only one thread may feed edges.
+   * Pulse widths come from the ticks; time_ns only stamps frames, so it is taken afresh with
+   * every edge and never accumulated from tick differences.
+   * @param tick Microsecond tick counter at the edge, wrapping at 2^32
+   * @param time_ns The edge on the get_time_ns() clock
+   */
+  void onEdge(uint32_t tick, uint64_t time_ns);
+
+  /** Copy the most recent complete frame.
+   * @return False if no frame has been decoded yet
+   */
+  bool latest(RCFrame& frame) const;
+
+  /** Copy the statistics as of the most recent frame.
+   */
+  bool getStats(PPMStats& stats) const;
+
+private:
+  void publishFrame();
+
+  uint32_t channel_count_;
+  uint32_t sync_length_;
+
+  // Decoder state, owned by the thread feeding edges
+  uint32_t previous_tick_;
+  uint64_t previous_time_ns_;  // Of the previous edge, on the get_time_ns() clock
+  bool synced_;
+  uint32_t current_channel_;
+  uint16_t pending_[RCFrame::kMaxChannels];
+  uint32_t sequence_;
+  PPMStats stats_;
+
+  SampleRing<RCFrame, 4> frames_;
+  SampleRing<PPMStats, 2> published_stats_;
+};
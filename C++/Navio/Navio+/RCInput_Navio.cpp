@@ -1,11 +1,14 @@
 #include <stdio.h>
+#include <string.h>
 #include <pigpio/pigpio.h>
 
+#include "../Common/Util.h"
+
 #include "./RCInput_Navio.h"
 
 using namespace Navio;
 
-RCInput_Navio::RCInput_Navio()
+RCInput_Navio::RCInput_Navio() : decoder(ppmChannelsNumber, ppmSyncLength)
 {
 }
 
@@ -20,13 +23,10 @@ void RCInput_Navio::ppmOnEdge(int, int level, uint32_t tick)
 {
   if (level == 0)
   {
-    deltaTime = tick - previousTick;
-    previousTick = tick;
-
-    if (deltaTime >= ppmSyncLength)  // Sync
-      currentChannel = 0;
-    else if (currentChannel < ppmChannelsNumber)
-      channels[currentChannel++] = deltaTime;
+    // pigpio reports edges late, by the age of the edge on its own tick counter
+    const uint64_t now = get_time_ns();
+    const uint32_t age = gpioTick() - tick;
+    decoder.onEdge(tick, now - static_cast<uint64_t>(age) * 1000);
   }
 }
 
@@ -49,16 +49,44 @@ void RCInput_Navio::initialize()
   gpioInitialise();
   gpioSetMode(4, PI_INPUT);
 
-  previousTick = gpioTick();
+  decoder.reset(gpioTick());
   gpioSetAlertFuncEx(ppmInputGpio, RCInput_Navio::ppmOnEdgeTrampolin, this);
 }
 
 int RCInput_Navio::read(int ch)
 {
-  if (static_cast<uint32_t>(ch) > ppmChannelsNumber)
+  if (ch < 0 || static_cast<uint32_t>(ch) >= ppmChannelsNumber)
   {
     fprintf(stderr, "Channel number too large\n");
     return -1;
   }
-  return channels[ch];
+
+  RCFrame frame;
+  if (!decoder.latest(frame))
+  {
+    return 0;
+  }
+  return frame.channels[ch];
+}
+
+bool RCInput_Navio::readFrame(RCFrame& frame)
+{
+  if (!decoder.latest(frame))
+  {
+    memset(&frame, 0, sizeof(RCFrame));
+    frame.channel_count = ppmChannelsNumber;
+    frame.failsafe = true;
+    return false;
+  }
+
+  frame.failsafe = get_time_ns() > frame.timestamp + kFailsafeTimeoutNs;
+
+  const bool updated = frame.sequence != lastReadSequence;
+  lastReadSequence = frame.sequence;
+  return updated;
+}
+
+bool RCInput_Navio::readStats(PPMStats& stats) const
+{
+  return decoder.getStats(stats);
 }
@@ -2,6 +2,7 @@
 
 #include "../Common/gpio.h"
 #include "../Common/RCInput.h"
+#include "./PPMDecoder.h"
 
 class RCInput_Navio : public RCInput
 {
@@ -10,11 +11,22 @@ public:
   void initialize() override;
   int read(int ch) override;
 
+  /** Frames are published from the PPM edge callback as soon as their last channel is measured.
+   * failsafe is set when no complete frame arrived for kFailsafeTimeoutNs.
+   */
+  bool readFrame(RCFrame& frame) override;
+
+  /** Per-channel jitter and frame counters of the PPM decoder.
+   * @return False if no frame has been decoded yet
+   */
+  bool readStats(PPMStats& stats) const;
+
 private:
   void ppmOnEdge(int, int level, uint32_t tick);
   static void ppmOnEdgeTrampolin(int gpio, int level, uint32_t tick, void* userdata);
 
   static const uint8_t outputEnablePin = RPI_GPIO_27;
+  static constexpr uint64_t kFailsafeTimeoutNs = 100000000;  // 5 frames at 50Hz
 
   //================================ Options =====================================
 
@@ -23,15 +35,9 @@ private:
   uint32_t ppmSyncLength = 4000;     // Length of PPM sync pause
   uint32_t ppmChannelsNumber = 8;    // Number of channels packed in PPM
   uint32_t servoFrequency = 50;      // Servo control frequency
-  bool verboseOutputEnabled = true;  // Output channels values to console
-
-  //================================== Data ======================================
-
-  float channels[8];
 
   //============================== PPM decoder ===================================
 
-  uint32_t currentChannel = 0;
-  uint32_t previousTick;
-  uint32_t deltaTime;
+  PPMDecoder decoder;
+  uint32_t lastReadSequence = 0;
 };
@@ -7,7 +7,7 @@ RCOutput_Navio::RCOutput_Navio()
 {
 }
 
-bool RCOutput_Navio::initialize(const size_t&)
+bool RCOutput_Navio::initialize(size_t)
 {
   static constexpr uint8_t outputEnablePin = RPI_GPIO_27;
 
@@ -26,20 +26,35 @@ bool RCOutput_Navio::initialize(const size_t&)
   return true;
 }
 
-bool RCOutput_Navio::enable(const size_t&)
+bool RCOutput_Navio::enable(size_t)
 {
   pwm_.initialize();
   return true;
 }
 
-bool RCOutput_Navio::setFrequency(const size_t&, const size_t& frequency)
+bool RCOutput_Navio::setFrequency(size_t, size_t frequency)
 {
   pwm_.setFrequency(frequency);
   return true;
 }
 
-bool RCOutput_Navio::setDutyCycle(const size_t& channel, const double& period)
+bool RCOutput_Navio::setDutyCycle(size_t channel, double period)
 {
-  pwm_.setPWMmS(channel + 3, period / 1000);  // 1st Navio RC output is 3
+  pwm_.setPWMmS(channel + kFirstOutput, period / 1000);
   return true;
 }
+
+size_t RCOutput_Navio::getChannelCount() const
+{
+  return kChannels;
+}
+
+bool RCOutput_Navio::setDutyCycles(size_t first_channel, std::span<const double> period_us)
+{
+  if (first_channel + period_us.size() > getChannelCount())
+  {
+    return false;
+  }
+
+  return pwm_.setPWMsuS(first_channel + kFirstOutput, period_us);  // One transaction for all
+}
@@ -7,11 +7,20 @@ class RCOutput_Navio : public RCOutput
 {
 public:
   explicit RCOutput_Navio();
-  bool initialize(const size_t&) override;
-  bool enable(const size_t&) override;
-  bool setFrequency(const size_t&, const size_t& frequency) override;
-  bool setDutyCycle(const size_t& channel, const double& period) override;
+  bool initialize(size_t) override;
+  bool enable(size_t) override;
+  bool setFrequency(size_t, size_t frequency) override;
+  bool setDutyCycle(size_t channel, double period) override;
+  size_t getChannelCount() const override;
+
+  /** All channels are written in one I2C transaction and the PCA9685 latches them together on the
+   * STOP condition, so a committed frame has no skew between channels.
+   */
+  bool setDutyCycles(size_t first_channel, std::span<const double> period_us) override;
 
 private:
+  static constexpr size_t kFirstOutput = 3;  // 1st Navio RC output is PCA9685 channel 3
+  static constexpr size_t kChannels = 16 - kFirstOutput;
+
   PCA9685 pwm_;
 };
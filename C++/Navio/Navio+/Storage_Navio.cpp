@@ -0,0 +1,29 @@
+#include "./Storage_Navio.h"
+
+Storage_Navio::Storage_Navio()
+{
+}
+
+bool Storage_Navio::initialize()
+{
+  uint8_t data;
+  return fram.readByte(0, &data);
+}
+
+bool Storage_Navio::read(size_t offset, std::span<uint8_t> data)
+{
+  if (offset > kSize || data.size() > kSize - offset)
+  {
+    return false;
+  }
+  return fram.readBytes(offset, data.size(), data.data());
+}
+
+bool Storage_Navio::write(size_t offset, std::span<const uint8_t> data)
+{
+  if (offset > kSize || data.size() > kSize - offset)
+  {
+    return false;
+  }
+  return fram.writeBytes(offset, data.size(), data.data());
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "../Common/Storage.h"
+#include "./MB85RC256.h"
+
+class Storage_Navio : public Storage
+{
+public:
+  explicit Storage_Navio();
+
+  bool initialize() override;
+  bool read(size_t offset, std::span<uint8_t> data) override;
+  bool write(size_t offset, std::span<const uint8_t> data) override;
+
+private:
+  static_assert(MB85RC256::kSize == kSize);
+
+  MB85RC256 fram;
+};
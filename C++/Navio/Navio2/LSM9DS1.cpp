@@ -1,4 +1,5 @@
 #include <cmath>
+#include <algorithm>
 
 #include "./LSM9DS1.h"
 
@@ -13,7 +14,9 @@
 #define INITIALIZE_SLEEP 200  // [us]
 
 LSM9DS1::LSM9DS1()
-  : spi_dev_imu_(DEVICE_ACC_GYRO, kSpiSpeedHz), spi_dev_mag_(DEVICE_MAG, kSpiSpeedHz)
+  : spi_dev_imu_(DEVICE_ACC_GYRO, kSpiSpeedHz),
+    spi_dev_mag_(DEVICE_MAG, kSpiSpeedHz),
+    fifo_period_ns_(1000000000 / 952)
 {
 }
 
@@ -64,24 +67,121 @@ void LSM9DS1::initialize()
 
 void LSM9DS1::update()
 {
-  updateTemperature();
-  updateAccelerometer();
-  updateGyroscope();
+  // Temperature, status and gyroscope (contiguous) plus accelerometer in a single ioctl
+  uint8_t tx_tg[1 + XG_OUT_Z_H_G - XG_OUT_TEMP_L + 1] = { XG_OUT_TEMP_L | READ_FLAG };
+  uint8_t rx_tg[sizeof(tx_tg)] = { 0 };
+  uint8_t tx_xl[1 + 6] = { XG_OUT_X_L_XL | READ_FLAG };
+  uint8_t rx_xl[sizeof(tx_xl)] = { 0 };
+
+  spi_dev_imu_.queue(tx_tg, rx_tg, sizeof(tx_tg));
+  spi_dev_imu_.queue(tx_xl, rx_xl, sizeof(tx_xl));
+  spi_dev_imu_.submit();
+  const uint64_t timestamp = spi_dev_imu_.getTimestamp(midpoint_correction_);
+
+  decodeTemperature(&rx_tg[1]);
+  decodeGyroscope(&rx_tg[1 + XG_OUT_X_L_G - XG_OUT_TEMP_L]);
+  decodeAccelerometer(&rx_xl[1]);
+  publishSample(timestamp);
+
   updateMagnetometer();
 }
 
 void LSM9DS1::updateTemperature()
 {
   readRegsImu(XG_OUT_TEMP_L, &response_[0], 2);
-  temperature = (float)(((int16_t)response_[1] << 8) | response_[0]) / 256. + 25.;
+  decodeTemperature(response_);
 }
 
 void LSM9DS1::updateAccelerometer()
 {
   readRegsImu(XG_OUT_X_L_XL, &response_[0], 6);
+  decodeAccelerometer(response_);
+}
+
+void LSM9DS1::updateGyroscope()
+{
+  readRegsImu(XG_OUT_X_L_G, &response_[0], 6);
+  decodeGyroscope(response_);
+}
+
+void LSM9DS1::updateMagnetometer()
+{
+  readRegsMag(M_OUT_X_L_M, &response_[0], 6);
+  decodeMagnetometer(response_);
+}
+
+void LSM9DS1::enableFifo(uint8_t watermark)
+{
+  writeReg(spi_dev_imu_, XG_FIFO_CTRL, BITS_FMODE_BYPASS);  // Clears the FIFO
+  writeReg(spi_dev_imu_, XG_CTRL_REG9, BIT_CTRL9_FIFO_EN);
+  writeReg(spi_dev_imu_, XG_INT1_CTRL, BIT_INT1_FTH);
+  writeReg(spi_dev_imu_, XG_FIFO_CTRL, BITS_FMODE_CONTINUOUS | (watermark & BITS_FTH_MASK));
+  fifo_streaming_ = true;
+}
+
+void LSM9DS1::disableFifo()
+{
+  fifo_streaming_ = false;
+  writeReg(spi_dev_imu_, XG_FIFO_CTRL, BITS_FMODE_BYPASS);
+  writeReg(spi_dev_imu_, XG_INT1_CTRL, 0x00);
+  writeReg(spi_dev_imu_, XG_CTRL_REG9, 0x00);
+}
+
+bool LSM9DS1::isFifoWatermarkReached()
+{
+  return readReg(spi_dev_imu_, XG_FIFO_SRC) & BIT_FIFO_SRC_FTH;
+}
+
+std::span<const ImuSample> LSM9DS1::readFifo()
+{
+  const uint8_t fifo_src = readReg(spi_dev_imu_, XG_FIFO_SRC);
+  const uint64_t now = spi_dev_imu_.getTimestamp(midpoint_correction_);
+
+  const uint32_t samples = std::min<uint32_t>(fifo_src & BITS_FIFO_SRC_FSS, kFifoSize);
+  if (samples == 0)
+    return {};
+
+  // Slot by slot, as the reference drivers drain it: a slot is read through the gyroscope output
+  // and then the accelerometer output, the same way as a register read
+  fifo_tx_g_[0] = XG_OUT_X_L_G | READ_FLAG;
+  fifo_tx_xl_[0] = XG_OUT_X_L_XL | READ_FLAG;
+  for (uint32_t n = 0; n < samples; ++n)
+  {
+    spi_dev_imu_.queue(fifo_tx_g_, fifo_rx_g_[n], sizeof(fifo_tx_g_));
+    spi_dev_imu_.queue(fifo_tx_xl_, fifo_rx_xl_[n], sizeof(fifo_tx_xl_));
+  }
+  spi_dev_imu_.submit();
+
+  for (uint32_t n = 0; n < samples; ++n)
+  {
+    auto& sample = fifo_samples_[n];
+    sample.timestamp = now - (samples - 1 - n) * fifo_period_ns_;
+
+    decodeGyroscope(&fifo_rx_g_[n][1]);
+    sample.gx = gx_;
+    sample.gy = gy_;
+    sample.gz = gz_;
+
+    decodeAccelerometer(&fifo_rx_xl_[n][1]);
+    sample.ax = ax_;
+    sample.ay = ay_;
+    sample.az = az_;
+    samples_.publish(sample);
+  }
+
+  return { fifo_samples_, samples };
+}
+
+void LSM9DS1::decodeTemperature(const uint8_t* raw)
+{
+  temperature = (float)(((int16_t)raw[1] << 8) | raw[0]) / 256. + 25.;
+}
+
+void LSM9DS1::decodeAccelerometer(const uint8_t* raw)
+{
   for (size_t i = 0; i < 3; ++i)
   {
-    bit_data_[i] = ((int16_t)response_[2 * i + 1] << 8) | response_[2 * i];
+    bit_data_[i] = ((int16_t)raw[2 * i + 1] << 8) | raw[2 * i];
   }
 
   ax_ = -G_SI * ((float)bit_data_[1] * acc_scale_);
@@ -89,12 +189,11 @@ void LSM9DS1::updateAccelerometer()
   az_ = G_SI * ((float)bit_data_[2] * acc_scale_);
 }
 
-void LSM9DS1::updateGyroscope()
+void LSM9DS1::decodeGyroscope(const uint8_t* raw)
 {
-  readRegsImu(XG_OUT_X_L_G, &response_[0], 6);
   for (size_t i = 0; i < 3; ++i)
   {
-    bit_data_[i] = ((int16_t)response_[2 * i + 1] << 8) | response_[2 * i];
+    bit_data_[i] = ((int16_t)raw[2 * i + 1] << 8) | raw[2 * i];
   }
 
   gx_ = -DEG2RAD * ((float)bit_data_[1] * gyro_scale_);
@@ -102,12 +201,11 @@ void LSM9DS1::updateGyroscope()
   gz_ = DEG2RAD * ((float)bit_data_[2] * gyro_scale_);
 }
 
-void LSM9DS1::updateMagnetometer()
+void LSM9DS1::decodeMagnetometer(const uint8_t* raw)
 {
-  readRegsMag(M_OUT_X_L_M, &response_[0], 6);
   for (size_t i = 0; i < 3; ++i)
   {
-    bit_data_[i] = ((int16_t)response_[2 * i + 1] << 8) | response_[2 * i];
+    bit_data_[i] = ((int16_t)raw[2 * i + 1] << 8) | raw[2 * i];
   }
 
   mx_ = 100. * ((float)bit_data_[0] * mag_scale_);
@@ -124,10 +222,12 @@ void LSM9DS1::initializeGyroscope()
   writeReg(spi_dev_imu_, XG_CTRL_REG4, BITS_XEN_G | BITS_YEN_G | BITS_ZEN_G);
 
   // Configure gyroscope
-  writeReg(spi_dev_imu_, XG_CTRL_REG1_G, BITS_ODR_G_952HZ | scale | BITS_BW_G_0);
+  constexpr uint8_t odr = BITS_ODR_G_952HZ;
+  writeReg(spi_dev_imu_, XG_CTRL_REG1_G, odr | scale | BITS_BW_G_0);
 
-  // Set scale
+  // Set scale and sample period
   setGyroScale(scale);
+  setGyroRate(odr);
 
   usleep(INITIALIZE_SLEEP);
 }
@@ -185,6 +285,31 @@ void LSM9DS1::setGyroScale(uint8_t scale)
   }
 }
 
+void LSM9DS1::setGyroRate(uint8_t odr)
+{
+  switch (odr)
+  {
+    case BITS_ODR_G_14900mHZ:
+      fifo_period_ns_ = 1000000000000 / 14900;
+      break;
+    case BITS_ODR_G_59500mHZ:
+      fifo_period_ns_ = 1000000000000 / 59500;
+      break;
+    case BITS_ODR_G_119HZ:
+      fifo_period_ns_ = 1000000000 / 119;
+      break;
+    case BITS_ODR_G_238HZ:
+      fifo_period_ns_ = 1000000000 / 238;
+      break;
+    case BITS_ODR_G_476HZ:
+      fifo_period_ns_ = 1000000000 / 476;
+      break;
+    case BITS_ODR_G_952HZ:
+      fifo_period_ns_ = 1000000000 / 952;
+      break;
+  }
+}
+
 void LSM9DS1::setAccScale(uint8_t scale)
 {
   switch (scale)
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <span>
+
 #include "./Common/SPIdev.h"
 #include "./Common/InertialSensor.h"
 
@@ -9,6 +11,7 @@
 class LSM9DS1 : public InertialSensor
 {
   static constexpr uint32_t kSpiSpeedHz = 10000000;  // Maximum frequency is 10MHz
+  static constexpr uint32_t kFifoSize = 32;          // Gyroscope + accelerometer slots
 
 public:
   explicit LSM9DS1();
@@ -22,6 +25,32 @@ public:
   void updateGyroscope();
   void updateMagnetometer();
 
+  /**
+   * @brief Stream gyroscope and accelerometer samples through the FIFO in continuous mode.
+   * Call after initialize(). Temperature and magnetometer are still read by update(), which then
+   * stops publishing samples: getSamples() receives the FIFO samples from readFifo() only.
+   * @param watermark FIFO threshold (0-31), raises FTH in FIFO_SRC and INT1_A/G once reached
+   */
+  void enableFifo(uint8_t watermark = 16);
+
+  /**
+   * @brief Stop streaming and return the FIFO to bypass mode.
+   */
+  void disableFifo();
+
+  /**
+   * @brief Check whether the FIFO holds at least the configured watermark.
+   */
+  bool isFifoWatermarkReached();
+
+  /**
+   * @brief Drain every stored gyroscope + accelerometer slot in a single ioctl.
+   * Each slot is read as its gyroscope then its accelerometer output, like a register read.
+   * On overrun the oldest samples are lost and the remaining ones are still returned.
+   * @return Samples received since the previous call, oldest first. Valid until the next call.
+   */
+  std::span<const ImuSample> readFifo();
+
 private:
   enum who_am_i_t : uint8_t
   {
@@ -106,6 +135,19 @@ private:
     M_INT_THS_H_M = 0x33,
   };
 
+  enum fifo_config_t : uint8_t
+  {
+    BITS_FMODE_BYPASS = 0b000 << 5,
+    BITS_FMODE_FIFO = 0b001 << 5,
+    BITS_FMODE_CONTINUOUS = 0b110 << 5,
+    BITS_FTH_MASK = 0x1F,
+    BIT_CTRL9_FIFO_EN = 1 << 1,
+    BIT_INT1_FTH = 1 << 3,
+    BIT_FIFO_SRC_FTH = 1 << 7,
+    BIT_FIFO_SRC_OVRN = 1 << 6,
+    BITS_FIFO_SRC_FSS = 0x3F,
+  };
+
   enum gyro_config_t : uint8_t
   {
     BITS_XEN_G = 0x08,
@@ -186,11 +228,17 @@ private:
   void readRegsImu(const uint8_t& read_addr, uint8_t* read_buf, const uint32_t& bytes);
   void readRegsMag(const uint8_t& read_addr, uint8_t* read_buf, const uint32_t& bytes);
 
+  void decodeTemperature(const uint8_t* raw);
+  void decodeAccelerometer(const uint8_t* raw);
+  void decodeGyroscope(const uint8_t* raw);
+  void decodeMagnetometer(const uint8_t* raw);
+
   void initializeGyroscope();
   void initializeAccelerometer();
   void initializeMagnetometer();
 
   void setGyroScale(uint8_t scale);
+  void setGyroRate(uint8_t odr);
   void setAccScale(uint8_t scale);
   void setMagScale(uint8_t scale);
 
@@ -205,4 +253,12 @@ private:
   uint8_t rx_[255] = { 0 };
   uint8_t response_[6];
   int16_t bit_data_[3];
+
+  uint64_t fifo_period_ns_;  // Of the gyroscope ODR, which paces the FIFO
+
+  uint8_t fifo_tx_g_[1 + 6] = { 0 };
+  uint8_t fifo_tx_xl_[1 + 6] = { 0 };
+  uint8_t fifo_rx_g_[kFifoSize][1 + 6] = {};
+  uint8_t fifo_rx_xl_[kFifoSize][1 + 6] = {};
+  ImuSample fifo_samples_[kFifoSize];
 };
@@ -1,5 +1,8 @@
 #include <string>
 #include <iostream>
+#include <charconv>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "../Common/Util.h"
 #include "./PWM.h"
@@ -8,6 +11,17 @@ using namespace std;
 
 PWM::PWM()
 {
+  for (auto& fd : duty_cycle_fds_)
+    fd = -1;
+}
+
+PWM::~PWM()
+{
+  for (const auto fd : duty_cycle_fds_)
+  {
+    if (fd >= 0)
+      close(fd);
+  }
 }
 
 bool PWM::init(const size_t& channel)
@@ -31,7 +45,58 @@ bool PWM::setPeriod(const size_t& channel, const size_t& freq)
 
 bool PWM::setDutyCycle(const size_t& channel, const double& period_ms)
 {
-  const string path = "/sys/class/pwm/pwmchip0/pwm" + to_string(channel) + "/duty_cycle";
-  const int period_ns = period_ms * 1e+6;
-  return write_file(path.c_str(), "%u", period_ns) >= 0;
+  const int fd = dutyCycleFd(channel);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  char buffer[16];
+  const uint32_t period_ns = period_ms * 1e+6;
+  const auto end = to_chars(buffer, buffer + sizeof(buffer), period_ns).ptr;
+  const ssize_t length = end - buffer;
+
+  return pwrite(fd, buffer, length, 0) == length;
+}
+
+bool PWM::setDutyCycles(const size_t& first_channel, span<const double> period_ms)
+{
+  if (first_channel + period_ms.size() > kMaxChannels)
+  {
+    return false;
+  }
+
+  int fds[kMaxChannels];
+  char buffers[kMaxChannels][16];
+  ssize_t lengths[kMaxChannels];
+  for (size_t i = 0; i < period_ms.size(); ++i)
+  {
+    fds[i] = dutyCycleFd(first_channel + i);
+    const uint32_t period_ns = period_ms[i] * 1e+6;
+    const auto end = to_chars(buffers[i], buffers[i] + sizeof(buffers[i]), period_ns).ptr;
+    lengths[i] = end - buffers[i];
+  }
+
+  bool ok = true;
+  for (size_t i = 0; i < period_ms.size(); ++i)
+  {
+    ok &= fds[i] >= 0 && pwrite(fds[i], buffers[i], lengths[i], 0) == lengths[i];
+  }
+  return ok;
+}
+
+int PWM::dutyCycleFd(size_t channel)
+{
+  if (channel >= kMaxChannels)
+  {
+    return -1;
+  }
+
+  auto& fd = duty_cycle_fds_[channel];
+  if (fd < 0)
+  {
+    const string path = "/sys/class/pwm/pwmchip0/pwm" + to_string(channel) + "/duty_cycle";
+    fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+  }
+  return fd;
 }
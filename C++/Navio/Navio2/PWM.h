@@ -1,14 +1,40 @@
 #pragma once
 
 #include <cinttypes>
+#include <cstddef>
+#include <span>
 
 class PWM
 {
+  static constexpr size_t kMaxChannels = 14;
+
 public:
   explicit PWM();
+  ~PWM();
+
+  PWM(const PWM&) = delete;
+  PWM& operator=(const PWM&) = delete;
 
   bool init(const size_t& channel);
   bool enable(const size_t& channel);
   bool setPeriod(const size_t& channel, const size_t& freq);
+
+  /** Set the pulse width of one channel.
+   * The duty_cycle attribute is opened on first use and kept open, every update is a single
+   * pwrite().
+   */
   bool setDutyCycle(const size_t& channel, const double& period_ms);
+
+  /** Set the pulse widths of consecutive channels.
+   * Every file is opened and every value formatted before the first write, so the channels are
+   * updated by back-to-back pwrite() calls.
+   * @param first_channel Channel of period_ms[0]
+   * @return False if any channel failed, the remaining channels are still updated
+   */
+  bool setDutyCycles(const size_t& first_channel, std::span<const double> period_ms);
+
+private:
+  int dutyCycleFd(size_t channel);
+
+  int duty_cycle_fds_[kMaxChannels];  // -1 until the channel is first updated
 };
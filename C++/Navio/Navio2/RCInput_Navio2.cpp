@@ -1,5 +1,7 @@
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <charconv>
 #include <unistd.h>
 #include <fcntl.h>
 #include <err.h>
@@ -9,8 +11,22 @@
 
 #define RCIN_SYSFS_PATH "/sys/kernel/rcio/rcin"
 
-RCInput_Navio2::RCInput_Navio2()
+RCInput_Navio2::RCInput_Navio2() : connected_fd(-1)
 {
+  for (auto& fd : channels)
+    fd = -1;
+  memset(&last_frame, 0, sizeof(RCFrame));
+}
+
+RCInput_Navio2::~RCInput_Navio2()
+{
+  for (const auto fd : channels)
+  {
+    if (fd >= 0)
+      close(fd);
+  }
+  if (connected_fd >= 0)
+    close(connected_fd);
 }
 
 void RCInput_Navio2::initialize()
@@ -23,24 +39,52 @@ void RCInput_Navio2::initialize()
       perror("open");
     }
   }
+
+  connected_fd = ::open(RCIN_SYSFS_PATH "/connected", O_RDONLY | O_CLOEXEC);
 }
 
 int RCInput_Navio2::read(int ch)
 {
-  if (static_cast<size_t>(ch) > ARRAY_SIZE(channels))
+  if (ch < 0 || static_cast<size_t>(ch) >= ARRAY_SIZE(channels))
   {
     fprintf(stderr, "Channel number too large\n");
     return -1;
   }
 
-  char buffer[10];
-
-  if (::pread(channels[ch], buffer, ARRAY_SIZE(buffer), 0) < 0)
+  const int value = read_value(channels[ch]);
+  if (value < 0)
   {
     perror("pread");
   }
 
-  return atoi(buffer);
+  return value;
+}
+
+bool RCInput_Navio2::readFrame(RCFrame& frame)
+{
+  RCFrame current;
+  memset(&current, 0, sizeof(RCFrame));
+  current.channel_count = CHANNEL_COUNT;
+
+  for (size_t i = 0; i < CHANNEL_COUNT; ++i)
+  {
+    const int value = read_value(channels[i]);
+    current.channels[i] = value < 0 ? last_frame.channels[i] : value;
+  }
+  current.failsafe = connected_fd >= 0 && read_value(connected_fd) != 1;
+
+  const bool updated =
+    last_frame.sequence == 0 || current.failsafe != last_frame.failsafe ||
+    memcmp(current.channels, last_frame.channels, sizeof(current.channels)) != 0;
+  if (updated)
+  {
+    current.timestamp = get_time_ns();
+    current.sequence = last_frame.sequence + 1;
+    last_frame = current;
+  }
+
+  frame = last_frame;
+  return updated;
 }
 
 int RCInput_Navio2::open_channel(int channel)
@@ -57,3 +101,20 @@ int RCInput_Navio2::open_channel(int channel)
 
   return fd;
 }
+
+int RCInput_Navio2::read_value(int fd)
+{
+  char buffer[12];
+  const ssize_t length = ::pread(fd, buffer, sizeof(buffer), 0);
+  if (length <= 0)
+  {
+    return -1;
+  }
+
+  int value;
+  if (std::from_chars(buffer, buffer + length, value).ec != std::errc())
+  {
+    return -1;
+  }
+  return value;
+}
@@ -8,12 +8,23 @@ class RCInput_Navio2 : public RCInput
 {
 public:
   explicit RCInput_Navio2();
+  ~RCInput_Navio2() override;
+
   void initialize() override;
   int read(int ch) override;
 
+  /** rcio exposes neither a frame counter nor pollable attributes, so a frame counts as new when
+   * any channel or the connection state changed. Identical consecutive frames are reported once.
+   */
+  bool readFrame(RCFrame& frame) override;
+
 private:
   int open_channel(int ch);
+  static int read_value(int fd);
 
   static const size_t CHANNEL_COUNT = 14;
   int channels[CHANNEL_COUNT];
+  int connected_fd;  // -1 if the driver has no connected attribute
+
+  RCFrame last_frame;
 };
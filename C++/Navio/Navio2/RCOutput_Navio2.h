@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+
 #include "../Common/RCOutput.h"
 #include "./PWM.h"
 
@@ -8,12 +10,16 @@ class RCOutput_Navio2 : public RCOutput
 public:
   inline explicit RCOutput_Navio2();
 
-  inline bool initialize(const size_t& channel) override;
-  inline bool enable(const size_t& channel) override;
-  inline bool setFrequency(const size_t& channel, const size_t& frequency) override;
-  inline bool setDutyCycle(const size_t& channel, const double& period_us) override;
+  inline bool initialize(size_t channel) override;
+  inline bool enable(size_t channel) override;
+  inline bool setFrequency(size_t channel, size_t frequency) override;
+  inline bool setDutyCycle(size_t channel, double period_us) override;
+  inline size_t getChannelCount() const override;
+  inline bool setDutyCycles(size_t first_channel, std::span<const double> period_us) override;
 
 private:
+  static constexpr size_t kChannels = 14;
+
   PWM pwm_;
 };
 
@@ -21,22 +27,40 @@ inline RCOutput_Navio2::RCOutput_Navio2()
 {
 }
 
-inline bool RCOutput_Navio2::initialize(const size_t& channel)
+inline bool RCOutput_Navio2::initialize(size_t channel)
 {
   return pwm_.init(channel);
 }
 
-inline bool RCOutput_Navio2::enable(const size_t& channel)
+inline bool RCOutput_Navio2::enable(size_t channel)
 {
   return pwm_.enable(channel);
 }
 
-inline bool RCOutput_Navio2::setFrequency(const size_t& channel, const size_t& frequency)
+inline bool RCOutput_Navio2::setFrequency(size_t channel, size_t frequency)
 {
   return pwm_.setPeriod(channel, frequency);
 }
 
-inline bool RCOutput_Navio2::setDutyCycle(const size_t& channel, const double& period_us)
+inline bool RCOutput_Navio2::setDutyCycle(size_t channel, double period_us)
 {
   return pwm_.setDutyCycle(channel, period_us / 1000);
 }
+
+inline size_t RCOutput_Navio2::getChannelCount() const
+{
+  return kChannels;
+}
+
+inline bool RCOutput_Navio2::setDutyCycles(size_t first_channel, std::span<const double> period_us)
+{
+  if (first_channel + period_us.size() > kChannels)
+  {
+    return false;
+  }
+
+  double period_ms[kChannels];
+  std::transform(
+    period_us.begin(), period_us.end(), period_ms, [](double period) { return period / 1000; });
+  return pwm_.setDutyCycles(first_channel, { period_ms, period_us.size() });
+}
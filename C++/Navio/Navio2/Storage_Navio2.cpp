@@ -0,0 +1,73 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "./Storage_Navio2.h"
+
+Storage_Navio2::Storage_Navio2(const char* path) : path(path), fd(-1)
+{
+}
+
+Storage_Navio2::~Storage_Navio2()
+{
+  if (fd >= 0)
+    close(fd);
+}
+
+bool Storage_Navio2::initialize()
+{
+  // /var/lib/navio does not exist on a fresh image. Only the last level is created
+  const std::string file(path);
+  const auto slash = file.rfind('/');
+  if (slash != std::string::npos && slash > 0 && mkdir(file.substr(0, slash).c_str(), 0755) < 0
+      && errno != EEXIST)
+  {
+    fprintf(stderr, "Failed to create the directory of %s: %s\n", path, strerror(errno));
+    return false;
+  }
+
+  fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0)
+  {
+    fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+    return false;
+  }
+
+  // A new file reads as zeros, like an erased memory
+  struct stat st;
+  if (fstat(fd, &st) < 0 || (st.st_size < static_cast<off_t>(kSize) && ftruncate(fd, kSize) < 0))
+  {
+    perror("ftruncate");
+    close(fd);
+    fd = -1;
+    return false;
+  }
+  return true;
+}
+
+bool Storage_Navio2::read(size_t offset, std::span<uint8_t> data)
+{
+  if (fd < 0 || offset > kSize || data.size() > kSize - offset)
+  {
+    return false;
+  }
+  return ::pread(fd, data.data(), data.size(), offset) == static_cast<ssize_t>(data.size());
+}
+
+bool Storage_Navio2::write(size_t offset, std::span<const uint8_t> data)
+{
+  if (fd < 0 || offset > kSize || data.size() > kSize - offset)
+  {
+    return false;
+  }
+  if (::pwrite(fd, data.data(), data.size(), offset) != static_cast<ssize_t>(data.size()))
+  {
+    perror("pwrite");
+    return false;
+  }
+  return fdatasync(fd) == 0;
+}
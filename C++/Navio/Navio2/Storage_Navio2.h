@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../Common/Storage.h"
+
+/**
+ * @brief Storage in a file of Storage::kSize bytes, created on first use along with its directory.
+ * Writes go to their offset with pwrite() and are flushed with fdatasync(), so updating a few
+ * bytes rewrites only the blocks holding them.
+ */
+class Storage_Navio2 : public Storage
+{
+public:
+  explicit Storage_Navio2(const char* path = "/var/lib/navio/storage.bin");
+  ~Storage_Navio2() override;
+
+  bool initialize() override;
+  bool read(size_t offset, std::span<uint8_t> data) override;
+  bool write(size_t offset, std::span<const uint8_t> data) override;
+
+private:
+  const char* path;
+  int fd;
+};